@@ -0,0 +1,182 @@
+#ifndef ACCURACY_H
+#define ACCURACY_H
+
+#include "Eigen/Dense"
+#include <vector>
+
+/**
+ * Streaming accuracy statistics of a tracker.
+ *
+ * Every update is O(1) and memory is fixed: the statistics keep running sums
+ * of squared residuals, NEES and NIS instead of the samples themselves, plus
+ * a ring of the last `window` samples for a sliding-window view.
+ */
+namespace accuracy {
+
+/**
+ * Running sums of K values over every sample added and over the last window
+ * samples.
+ */
+template <int K>
+class RunningSums {
+ public:
+  typedef Eigen::Array<double, K, 1> Values;
+
+  /**
+   * Constructor
+   * @param {int} window: samples in the sliding window, 0 for none
+   */
+  explicit RunningSums(int window = 0)
+      : ring_(window), head_(0), filled_(0), count_(0) {
+    total_.setZero();
+    window_sum_.setZero();
+  }
+
+  void Add(const Values& v) {
+    total_ += v;
+    count_++;
+    const int window = ring_.size();
+    if (window == 0)
+      return;
+    if (filled_ == window)
+      window_sum_ -= ring_[head_];
+    else
+      filled_++;
+    ring_[head_] = v;
+    window_sum_ += v;
+    head_ = (head_ + 1) % window;
+
+    //re-sum once per lap so rounding from the subtractions cannot build up
+    if (head_ == 0) {
+      window_sum_.setZero();
+      for (int i = 0; i < window; i++)
+        window_sum_ += ring_[i];
+    }
+  }
+
+  long long count() const { return count_; }
+
+  // samples in the window, at most window
+  int window_count() const { return filled_; }
+
+  // mean over every sample, zero before the first one
+  Values Mean() const {
+    return count_ > 0 ? Values(total_ / double(count_)) : Values(Values::Zero());
+  }
+
+  // mean over the window, zero before the first sample
+  Values WindowMean() const {
+    return filled_ > 0 ? Values(window_sum_ / double(filled_)) : Values(Values::Zero());
+  }
+
+ private:
+  Values total_;
+  Values window_sum_;
+  std::vector<Values> ring_;
+  int head_;
+  int filled_;
+  long long count_;
+};
+
+/**
+ * Maps a CTRV-family state [px py v yaw ...] and its covariance to the
+ * evaluation space [px py vx vy], linearizing the velocity at the estimate.
+ * @param {StateVector} x: state
+ * 		  {StateMatrix} P: state covariance
+ * 		  {Vector4d*} estimate: [px py vx vy]
+ * 		  {Matrix4d*} cov: covariance of estimate, may be NULL
+ */
+template <class StateVector, class StateMatrix>
+void ToCartesian(const StateVector& x, const StateMatrix& P,
+                 Eigen::Vector4d* estimate, Eigen::Matrix4d* cov) {
+  const int n_x = StateVector::RowsAtCompileTime;
+  const double v = x(2);
+  const double c = std::cos(double(x(3)));
+  const double s = std::sin(double(x(3)));
+  *estimate << x(0), x(1), c*v, s*v;
+  if (!cov)
+    return;
+
+  Eigen::Matrix<double, 4, n_x> J;
+  J.setZero();
+  J(0,0) = 1;
+  J(1,1) = 1;
+  J(2,2) = c;
+  J(2,3) = -s*v;
+  J(3,2) = s;
+  J(3,3) = c*v;
+  *cov = J * P.template cast<double>() * J.transpose();
+}
+
+/**
+ * Accuracy of one target, or of several pooled together: RMSE of
+ * [px py vx vy], NEES of the estimate against the ground truth and NIS of
+ * the lidar and radar updates, each over the whole run and over a sliding
+ * window.
+ */
+class TargetAccuracy {
+ public:
+  /**
+   * Constructor
+   * @param {int} window: samples in the sliding window, 0 for none
+   */
+  explicit TargetAccuracy(int window = 0)
+      : errors_(window), nis_laser_(window), nis_radar_(window) {}
+
+  /**
+   * Adds one estimate.
+   * @param {Vector4d} estimate: [px py vx vy]
+   * 		  {Matrix4d} cov: covariance of estimate
+   * 		  {Vector4d} truth: ground truth [px py vx vy]
+   */
+  void AddEstimate(const Eigen::Vector4d& estimate, const Eigen::Matrix4d& cov,
+                   const Eigen::Vector4d& truth) {
+    const Eigen::Vector4d residual = estimate - truth;
+    Eigen::Array<double, 5, 1> v;
+    v.head<4>() = residual.array().square();
+    v(4) = residual.dot(cov.ldlt().solve(residual));
+    errors_.Add(v);
+  }
+
+  // adds the NIS of one lidar or radar update
+  void AddLaserNis(double nis) { nis_laser_.Add(Eigen::Array<double, 1, 1>::Constant(nis)); }
+  void AddRadarNis(double nis) { nis_radar_.Add(Eigen::Array<double, 1, 1>::Constant(nis)); }
+
+  /**
+   * Adds the lidar and radar NIS of a UKFFixed for the updates its last
+   * ProcessMeasurement or ProcessMeasurements call ran, so a skipped sensor
+   * or the initializing measurement adds nothing.
+   */
+  template <class Filter>
+  void AddNis(const Filter& filter) {
+    if (filter.laser_updated_)
+      AddLaserNis(filter.nis_laser_);
+    if (filter.radar_updated_)
+      AddRadarNis(filter.nis_radar_);
+  }
+
+  long long count() const { return errors_.count(); }
+
+  Eigen::Vector4d Rmse() const { return errors_.Mean().head<4>().sqrt().matrix(); }
+  Eigen::Vector4d WindowRmse() const { return errors_.WindowMean().head<4>().sqrt().matrix(); }
+
+  // average NEES, 4 for a consistent filter
+  double Nees() const { return errors_.Mean()(4); }
+  double WindowNees() const { return errors_.WindowMean()(4); }
+
+  // average NIS, 2 for lidar and 3 for radar for a consistent filter
+  double LaserNis() const { return nis_laser_.Mean()(0); }
+  double RadarNis() const { return nis_radar_.Mean()(0); }
+  double WindowLaserNis() const { return nis_laser_.WindowMean()(0); }
+  double WindowRadarNis() const { return nis_radar_.WindowMean()(0); }
+
+ private:
+  // squared residuals of px py vx vy, then NEES
+  RunningSums<5> errors_;
+  RunningSums<1> nis_laser_;
+  RunningSums<1> nis_radar_;
+};
+
+}  // namespace accuracy
+
+#endif  // ACCURACY_H
@@ -0,0 +1,73 @@
+#include "alloc_check.h"
+
+#ifdef UKF_CHECK_NO_MALLOC
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+// per thread, so a scope does not see the allocations of other threads;
+// plain integers need no allocation to reach from the wrappers below
+thread_local long t_allocations = 0;
+}
+
+long alloc_check::AllocationCount() {
+  return t_allocations;
+}
+
+#ifdef __GLIBC__
+
+// Eigen allocates with std::malloc, so the C allocator itself is wrapped
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* p, std::size_t size);
+
+void* malloc(std::size_t size) {
+  t_allocations++;
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t n, std::size_t size) {
+  t_allocations++;
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, std::size_t size) {
+  t_allocations++;
+  return __libc_realloc(p, size);
+}
+}
+
+#endif  // __GLIBC__
+
+void* operator new(std::size_t size) {
+#ifndef __GLIBC__
+  t_allocations++;
+#endif
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+#endif  // UKF_CHECK_NO_MALLOC
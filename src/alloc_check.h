@@ -0,0 +1,64 @@
+#ifndef ALLOC_CHECK_H
+#define ALLOC_CHECK_H
+
+/**
+ * Test hook for the allocation-free filter path.
+ *
+ * Configure with -DUKF_CHECK_NO_MALLOC=ON and every NoAllocScope aborts the
+ * program if the code it guards allocates. alloc_check.cpp counts the heap
+ * allocations of each thread: on glibc it wraps malloc, calloc and realloc,
+ * which also covers Eigen and the global operator new; elsewhere it only
+ * counts operator new, and Eigen allocations go unnoticed. In normal builds
+ * NoAllocScope is empty.
+ * Scopes may nest and may be open on several threads at once (IMM tracks
+ * run their filters on a ThreadPool). A scope only sees the allocations of
+ * its own thread.
+ */
+
+#ifdef UKF_CHECK_NO_MALLOC
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace alloc_check {
+
+/**
+ * Number of heap allocations the calling thread has made so far.
+ */
+long AllocationCount();
+
+class NoAllocScope {
+ public:
+  NoAllocScope() : start_(AllocationCount()) {}
+
+  ~NoAllocScope() {
+    long count = AllocationCount() - start_;
+    if (count != 0) {
+      std::fprintf(stderr, "alloc_check: %ld heap allocation(s) in a no-alloc scope\n", count);
+      std::abort();
+    }
+  }
+
+ private:
+  NoAllocScope(const NoAllocScope&);
+  NoAllocScope& operator=(const NoAllocScope&);
+
+  long start_;
+};
+
+}  // namespace alloc_check
+
+#else
+
+namespace alloc_check {
+
+class NoAllocScope {
+ public:
+  NoAllocScope() {}
+};
+
+}  // namespace alloc_check
+
+#endif  // UKF_CHECK_NO_MALLOC
+
+#endif  // ALLOC_CHECK_H
@@ -0,0 +1,99 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[8] = {'U', 'K', 'F', 'C', 'K', 'P', 'T', '\0'};
+const uint32_t kByteOrder = 0x01020304;
+
+}  // namespace
+
+checkpoint::Header checkpoint::MakeHeader(int n_x, int record_size, uint64_t count) {
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.byte_order = kByteOrder;
+  header.n_x = n_x;
+  header.record_size = record_size;
+  header.count = count;
+  return header;
+}
+
+bool checkpoint::WriteFile(const std::string& path, const Header& header, const void* records) {
+  const std::string tmp = path + ".tmp";
+  std::FILE* f = std::fopen(tmp.c_str(), "wb");
+  if (!f)
+    return false;
+
+  const size_t bytes = header.record_size * header.count;
+  bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+  if (ok && bytes > 0)
+    ok = std::fwrite(records, bytes, 1, f) == 1;
+  ok = std::fclose(f) == 0 && ok;
+
+  if (ok)
+    ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+  if (!ok)
+    std::remove(tmp.c_str());
+  return ok;
+}
+
+checkpoint::MappedFile::MappedFile() : data_(NULL), size_(0), count_(0) {}
+
+checkpoint::MappedFile::~MappedFile() {
+  Close();
+}
+
+bool checkpoint::MappedFile::Open(const std::string& path, int n_x, int record_size) {
+  Close();
+
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+    ::close(fd);
+    return false;
+  }
+  void* data = ::mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  data_ = data;
+  size_ = st.st_size;
+
+  //the layout must be exactly the one this build reads
+  const Header* header = static_cast<const Header*>(data_);
+  const bool match = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0
+                     && header->version == kVersion
+                     && header->byte_order == kByteOrder
+                     && header->n_x == (uint32_t)n_x
+                     && header->record_size == (uint32_t)record_size
+                     && header->count <= (size_ - sizeof(Header)) / record_size;
+  if (!match) {
+    Close();
+    return false;
+  }
+
+  count_ = header->count;
+  return true;
+}
+
+void checkpoint::MappedFile::Close() {
+  if (data_)
+    ::munmap(data_, size_);
+  data_ = NULL;
+  size_ = 0;
+  count_ = 0;
+}
+
+const void* checkpoint::MappedFile::records() const {
+  return static_cast<const char*>(data_) + sizeof(Header);
+}
@@ -0,0 +1,207 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Binary checkpoints of filter state for a warm restart.
+ *
+ * A file is a Header followed by count fixed-size Record<NX>s in native
+ * byte order, so restoring maps the file and copies each record straight
+ * into its filter; nothing is parsed. A record holds everything that
+ * carries over between measurements: time, pending prediction, x, P, the
+ * square-root factor, flags and tuning. The out-of-sequence history and
+ * the scratch workspace are not saved, a restored filter starts with an
+ * empty history.
+ *
+ * The header carries a magic, a format version, a byte order marker, NX and
+ * the record size, and Open rejects any file that does not match the
+ * Record it is read as.
+ */
+namespace checkpoint {
+
+// bump when Record changes layout
+const uint32_t kVersion = 1;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t n_x;
+  uint32_t record_size;
+  uint64_t count;
+};
+
+/**
+ * Saved state of one filter with NX state components, always in double.
+ */
+template <int NX>
+struct Record {
+  int64_t time_us;
+  double pending_dt;
+
+  uint8_t is_initialized;
+  uint8_t use_laser;
+  uint8_t use_radar;
+  uint8_t use_sqrt;
+  uint8_t padding[4];
+
+  double std_a;
+  double std_yawdd;
+  double std_laspx;
+  double std_laspy;
+  double std_radr;
+  double std_radphi;
+  double std_radrd;
+
+  double x[NX];
+  double P[NX * NX];
+  double S[NX * NX];
+};
+
+/**
+ * Fills a header for count records of NX components.
+ */
+Header MakeHeader(int n_x, int record_size, uint64_t count);
+
+/**
+ * Writes a header and count records of record_size bytes to path. The data
+ * goes to path + ".tmp" first and is renamed over path, so a reader never
+ * sees a half-written checkpoint.
+ * @return false on any I/O error
+ */
+bool WriteFile(const std::string& path, const Header& header, const void* records);
+
+/**
+ * Read-only memory map of a checkpoint file.
+ */
+class MappedFile {
+ public:
+  MappedFile();
+  ~MappedFile();
+
+  /**
+   * Maps path and checks its header against n_x and record_size.
+   * @return false if the file is missing, short or does not match
+   */
+  bool Open(const std::string& path, int n_x, int record_size);
+
+  void Close();
+
+  // number of records, 0 when closed
+  uint64_t count() const { return count_; }
+
+  // first record, right after the header
+  const void* records() const;
+
+ private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+
+  void* data_;
+  size_t size_;
+  uint64_t count_;
+};
+
+/**
+ * Copies the state of a UKFFixed (or anything with its members) to a record.
+ */
+template <class Filter>
+void Save(const Filter& filter, Record<Filter::n_x_>* record) {
+  const int n_x = Filter::n_x_;
+  record->time_us = filter.time_us_;
+  record->pending_dt = filter.pending_dt_;
+  record->is_initialized = filter.is_initialized_;
+  record->use_laser = filter.use_laser_;
+  record->use_radar = filter.use_radar_;
+  record->use_sqrt = filter.use_sqrt_;
+  for (int i = 0; i < 4; i++)
+    record->padding[i] = 0;
+  record->std_a = filter.std_a_;
+  record->std_yawdd = filter.std_yawdd_;
+  record->std_laspx = filter.std_laspx_;
+  record->std_laspy = filter.std_laspy_;
+  record->std_radr = filter.std_radr_;
+  record->std_radphi = filter.std_radphi_;
+  record->std_radrd = filter.std_radrd_;
+  for (int i = 0; i < n_x; i++)
+    record->x[i] = filter.x_(i);
+  for (int i = 0; i < n_x * n_x; i++) {
+    record->P[i] = filter.P_(i);
+    record->S[i] = filter.S_(i);
+  }
+}
+
+/**
+ * Restores a filter from a record, clears its history and publishes the
+ * restored state.
+ */
+template <class Filter>
+void Load(const Record<Filter::n_x_>& record, Filter* filter) {
+  typedef typename Filter::Scalar Scalar;
+  const int n_x = Filter::n_x_;
+  filter->time_us_ = record.time_us;
+  filter->pending_dt_ = record.pending_dt;
+  filter->is_initialized_ = record.is_initialized != 0;
+  filter->use_laser_ = record.use_laser != 0;
+  filter->use_radar_ = record.use_radar != 0;
+  filter->use_sqrt_ = record.use_sqrt != 0;
+  filter->std_a_ = record.std_a;
+  filter->std_yawdd_ = record.std_yawdd;
+  filter->std_laspx_ = record.std_laspx;
+  filter->std_laspy_ = record.std_laspy;
+  filter->std_radr_ = record.std_radr;
+  filter->std_radphi_ = record.std_radphi;
+  filter->std_radrd_ = record.std_radrd;
+  for (int i = 0; i < n_x; i++)
+    filter->x_(i) = Scalar(record.x[i]);
+  for (int i = 0; i < n_x * n_x; i++) {
+    filter->P_(i) = Scalar(record.P[i]);
+    filter->S_(i) = Scalar(record.S[i]);
+  }
+  filter->SetHistoryDepth(filter->history_.size());
+  filter->Publish();
+}
+
+/**
+ * Saves n filters to a checkpoint file.
+ * @param {string} path: file to write
+ * 		  {const Filter*} filters: n filters
+ * 		  {int} n: number of filters
+ * @return false on any I/O error
+ */
+template <class Filter>
+bool SaveFile(const std::string& path, const Filter* filters, int n) {
+  typedef Record<Filter::n_x_> R;
+  std::vector<R> records(n);
+  for (int i = 0; i < n; i++)
+    Save(filters[i], &records[i]);
+  return WriteFile(path, MakeHeader(Filter::n_x_, sizeof(R), n), records.data());
+}
+
+/**
+ * Restores up to n filters from a checkpoint file, record i into filter i.
+ * @param {string} path: file to read
+ * 		  {Filter*} filters: n filters
+ * 		  {int} n: number of filters
+ * @return number of filters restored, -1 if the file is missing or does not
+ * 		  match
+ */
+template <class Filter>
+int LoadFile(const std::string& path, Filter* filters, int n) {
+  typedef Record<Filter::n_x_> R;
+  MappedFile file;
+  if (!file.Open(path, Filter::n_x_, sizeof(R)))
+    return -1;
+  const R* records = static_cast<const R*>(file.records());
+  const int count = file.count() < (uint64_t)n ? (int)file.count() : n;
+  for (int i = 0; i < count; i++)
+    Load(records[i], &filters[i]);
+  return count;
+}
+
+}  // namespace checkpoint
+
+#endif  // CHECKPOINT_H
@@ -0,0 +1,138 @@
+#ifndef CTRV_KERNEL_H
+#define CTRV_KERNEL_H
+
+#include "simd_math.h"
+
+/**
+ * Vectorized CTRV process and radar measurement models.
+ *
+ * Sigma points are passed as rows: one contiguous array per state
+ * component, n lanes each. UKFFixed stores its sigma point matrices row-major
+ * so its rows are the lanes of one track; UKFBank passes the lanes of one
+ * sigma point across all tracks. Both run the same code.
+ */
+namespace ctrv {
+
+/**
+ * Propagates one pack of augmented sigma points through the CTRV model.
+ * The near-zero yaw rate case is blended in instead of branched on.
+ */
+template <class V>
+inline void Propagate(const V in[7], V d, V out[5]) {
+  const V p_x = in[0], p_y = in[1], v = in[2], yaw = in[3], yawd = in[4];
+  const V nu_a = in[5], nu_yawdd = in[6];
+
+  V s0, c0, s1, c1;
+  const V yaw1 = yaw + yawd * d;
+  simd_math::SinCos(yaw, &s0, &c0);
+  simd_math::SinCos(yaw1, &s1, &c1);
+
+  //avoid division by zero: straight line where |yawd| <= 0.001
+  typename V::Mask turning = simd_math::Abs(yawd) > V(0.001);
+  const V k = v / simd_math::Select(turning, yawd, V(1.0));
+  const V vd = v * d;
+  const V dx = simd_math::Select(turning, k * (s1 - s0), vd * c0);
+  const V dy = simd_math::Select(turning, k * (c0 - c1), vd * s0);
+
+  //add noise
+  const V half_dd = V(0.5) * d * d;
+  out[0] = p_x + dx + half_dd * nu_a * c0;
+  out[1] = p_y + dy + half_dd * nu_a * s0;
+  out[2] = v + nu_a * d;
+  out[3] = yaw1 + half_dd * nu_yawdd;
+  out[4] = yawd + nu_yawdd * d;
+}
+
+/**
+ * Maps one pack of predicted sigma points to radar space [rho, phi, rho_dot].
+ */
+template <class V>
+inline void Radar(const V in[4], V out[3]) {
+  const V p_x = in[0], p_y = in[1], v = in[2], yaw = in[3];
+
+  V s, c;
+  simd_math::SinCos(yaw, &s, &c);
+
+  const V rho = simd_math::Sqrt(p_x * p_x + p_y * p_y);
+  out[0] = rho;
+  out[1] = simd_math::Atan2(p_y, p_x);
+  out[2] = (p_x * c * v + p_y * s * v) / rho;
+}
+
+namespace internal {
+
+template <class V, typename T>
+inline void PredictAt(const T* const Xaug[7], T* const Xpred[5], V d, int i) {
+  V in[7], out[5];
+  for (int r = 0; r < 7; r++)
+    in[r] = V::Load(Xaug[r] + i);
+  Propagate(in, d, out);
+  for (int r = 0; r < 5; r++)
+    out[r].Store(Xpred[r] + i);
+}
+
+template <class V, typename T>
+inline void RadarAt(const T* const Xpred[4], T* const Zsig[3], int i) {
+  V in[4], out[3];
+  for (int r = 0; r < 4; r++)
+    in[r] = V::Load(Xpred[r] + i);
+  Radar(in, out);
+  for (int r = 0; r < 3; r++)
+    out[r].Store(Zsig[r] + i);
+}
+
+}  // namespace internal
+
+/**
+ * Propagates n lanes of augmented sigma points by delta_t. T is double or
+ * float; float runs twice the lanes per vector.
+ * @param {const T* const[7]} Xaug: rows px, py, v, yaw, yawd, nu_a, nu_yawdd
+ * 		  {T* const[5]} Xpred: rows px, py, v, yaw, yawd of the result
+ * 		  {double} delta_t: time step in s, shared by all lanes
+ * 		  {int} n: number of lanes
+ */
+template <typename T>
+inline void PredictSigmaPoints(const T* const Xaug[7], T* const Xpred[5], double delta_t, int n) {
+  typedef typename simd_math::Lanes<T>::Vec Vec;
+  typedef typename simd_math::Lanes<T>::One One;
+  int i = 0;
+  for (; i + Vec::kWidth <= n; i += Vec::kWidth)
+    internal::PredictAt(Xaug, Xpred, Vec(delta_t), i);
+  for (; i < n; i++)
+    internal::PredictAt(Xaug, Xpred, One(delta_t), i);
+}
+
+/**
+ * Same as above with a time step per lane.
+ */
+template <typename T>
+inline void PredictSigmaPoints(const T* const Xaug[7], T* const Xpred[5], const T* delta_t, int n) {
+  typedef typename simd_math::Lanes<T>::Vec Vec;
+  typedef typename simd_math::Lanes<T>::One One;
+  int i = 0;
+  for (; i + Vec::kWidth <= n; i += Vec::kWidth)
+    internal::PredictAt(Xaug, Xpred, Vec::Load(delta_t + i), i);
+  for (; i < n; i++)
+    internal::PredictAt(Xaug, Xpred, One::Load(delta_t + i), i);
+}
+
+/**
+ * Maps n lanes of predicted sigma points to radar space.
+ * @param {const T* const[4]} Xpred: rows px, py, v, yaw
+ * 		  {T* const[3]} Zsig: rows rho, phi, rho_dot of the result
+ * 		  {int} n: number of lanes
+ */
+template <typename T>
+inline void RadarMeasurement(const T* const Xpred[4], T* const Zsig[3], int n) {
+  typedef typename simd_math::Lanes<T>::Vec Vec;
+  typedef typename simd_math::Lanes<T>::One One;
+  int i = 0;
+  for (; i + Vec::kWidth <= n; i += Vec::kWidth)
+    internal::RadarAt<Vec>(Xpred, Zsig, i);
+  for (; i < n; i++)
+    internal::RadarAt<One>(Xpred, Zsig, i);
+}
+
+}  // namespace ctrv
+
+#endif  // CTRV_KERNEL_H
@@ -4,6 +4,7 @@
 #include "render/render.h"
 #include "sensors/lidar.h"
 #include "tools.h"
+#include "accuracy.h"
 
 class Highway
 {
@@ -15,6 +16,10 @@ public:
 	bool pass = true;
 	std::vector<double> rmseThreshold = {0.30,0.16,0.95,0.70};
 	std::vector<double> rmseFailLog = {0.0,0.0,0.0,0.0};
+	// accuracy of all tracked cars pooled, and of each car, with a 3 s window
+	// at 30 fps
+	accuracy::TargetAccuracy totalAccuracy = accuracy::TargetAccuracy(90);
+	std::vector<accuracy::TargetAccuracy> targetAccuracy;
 	Lidar* lidar;
 	
 	// Parameters 
@@ -25,16 +30,23 @@ public:
 	bool visualize_lidar = true;
 	bool visualize_radar = true;
 	bool visualize_pcd = false;
+	// Scan the traffic and poles with the simulated lidar every frame and
+	// render the cloud
+	bool simulate_lidar = false;
 	// Predict path in the future using UKF
 	double projectedTime = 0;
 	int projectedSteps = 0;
+	// Record every evaluated estimate in tools.history, spilling past
+	// historyMemoryRows rows to historyFile, and report the RMSE of each
+	// tracked car from it at the end of the run
+	bool recordHistory = false;
+	std::string historyFile = "ukf_history.bin";
+	long long historyMemoryRows = 4*HistoryStore::kChunkRows;
 	// --------------------------------
 
 	Highway(pcl::visualization::PCLVisualizer::Ptr& viewer)
 	{
 
-		tools = Tools();
-	
 		egoCar = Car(Vect3(0, 0, 0), Vect3(4, 2, 2), Color(0, 1, 0), 0, 0, 2, "egoCar");
 		
 		Car car1(Vect3(-10, 4, 0), Vect3(4, 2, 2), Color(0, 0, 1), 5, 0, 2, "car1");
@@ -94,6 +106,9 @@ public:
 			car3.setUKF(ukf3);
 		}
 		traffic.push_back(car3);
+		targetAccuracy.assign(traffic.size(), accuracy::TargetAccuracy(90));
+		if(recordHistory && !tools.history.SetSpillFile(historyFile, historyMemoryRows))
+			std::cerr << "cannot open " << historyFile << ", keeping the history in memory" << std::endl;
 
 		lidar = new Lidar(traffic,0);
 	
@@ -127,29 +142,45 @@ public:
 			// Sense surrounding cars with lidar and radar
 			if(trackCars[i])
 			{
-				VectorXd gt(4);
+				Eigen::Vector4d gt;
 				gt << traffic[i].position.x, traffic[i].position.y, traffic[i].velocity*cos(traffic[i].angle), traffic[i].velocity*sin(traffic[i].angle);
-				tools.ground_truth.push_back(gt);
-				tools.lidarSense(traffic[i], viewer, timestamp, visualize_lidar);
-				tools.radarSense(traffic[i], egoCar, viewer, timestamp, visualize_radar);
+				// both sensors fire at this timestamp: predict once, update with both
+				MeasurementPackage meas_packages[2];
+				tools.lidarSense(traffic[i], viewer, timestamp, visualize_lidar, meas_packages[0]);
+				tools.radarSense(traffic[i], egoCar, viewer, timestamp, visualize_radar, meas_packages[1]);
+				traffic[i].ukf.ProcessMeasurements(meas_packages, 2);
+				// runs any prediction a disabled sensor left pending and
+				// publishes the state; evaluation reads the published copy
+				traffic[i].ukf.StateAt(timestamp);
+				UKF::Snapshot snapshot;
+				traffic[i].ukf.published_.Read(&snapshot);
 				tools.ukfResults(traffic[i],viewer, projectedTime, projectedSteps);
-				VectorXd estimate(4);
-				double v  = traffic[i].ukf.x_(2);
-    			double yaw = traffic[i].ukf.x_(3);
-    			double v1 = cos(yaw)*v;
-    			double v2 = sin(yaw)*v;
-				estimate << traffic[i].ukf.x_[0], traffic[i].ukf.x_[1], v1, v2;
-				tools.estimations.push_back(estimate);
+				Eigen::Vector4d estimate;
+				Eigen::Matrix4d cov;
+				accuracy::ToCartesian(snapshot.x, snapshot.P, &estimate, &cov);
+				totalAccuracy.AddEstimate(estimate, cov, gt);
+				totalAccuracy.AddNis(traffic[i].ukf);
+				targetAccuracy[i].AddEstimate(estimate, cov, gt);
+				targetAccuracy[i].AddNis(traffic[i].ukf);
+				if(recordHistory)
+					tools.history.Append(timestamp, i, estimate.data(), gt.data());
 	
 			}
 		}
+
+		if(simulate_lidar)
+		{
+			lidar->updateScene(traffic, egoVelocity*timestamp/1e6);
+			renderPointCloud(viewer, lidar->scan(), "lidarCloud", Color(1, 1, 1));
+		}
 		
 		viewer->addText("Accuracy - RMSE:", 30, 300, 20, 1, 1, 1, "rmse");
-		VectorXd rmse = tools.CalculateRMSE(tools.estimations, tools.ground_truth);
+		Eigen::Vector4d rmse = totalAccuracy.Rmse();
 		viewer->addText(" X: "+std::to_string(rmse[0]), 30, 275, 20, 1, 1, 1, "rmse_x");
 		viewer->addText(" Y: "+std::to_string(rmse[1]), 30, 250, 20, 1, 1, 1, "rmse_y");
 		viewer->addText("Vx: "	+std::to_string(rmse[2]), 30, 225, 20, 1, 1, 1, "rmse_vx");
 		viewer->addText("Vy: "	+std::to_string(rmse[3]), 30, 200, 20, 1, 1, 1, "rmse_vy");
+		viewer->addText("NEES: "+std::to_string(totalAccuracy.Nees())+" NIS L: "+std::to_string(totalAccuracy.LaserNis())+" R: "+std::to_string(totalAccuracy.RadarNis()), 30, 175, 20, 1, 1, 1, "consistency");
 
 		if(timestamp > 1.0e6)
 		{
@@ -190,4 +221,19 @@ public:
 		
 	}
 	
+	// prints the RMSE of each tracked car over the whole run, from the
+	// recorded history
+	void reportHistory()
+	{
+		if(!recordHistory)
+			return;
+		for(int i = 0; i < traffic.size(); i++)
+		{
+			if(!trackCars[i])
+				continue;
+			VectorXd rmse = tools.CalculateRMSE(tools.history, i);
+			std::cout << traffic[i].name << " RMSE X: " << rmse[0] << " Y: " << rmse[1] << " Vx: " << rmse[2] << " Vy: " << rmse[3] << std::endl;
+		}
+	}
+
 };
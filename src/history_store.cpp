@@ -0,0 +1,102 @@
+#include "history_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t kChunkBytes = sizeof(double) * HistoryStore::kColumns * HistoryStore::kChunkRows;
+
+}  // namespace
+
+HistoryStore::HistoryStore()
+  : size_(0), spill_threshold_(0), spill_fd_(-1), spill_chunks_(0) {}
+
+HistoryStore::~HistoryStore() {
+  FreeChunks();
+  CloseSpill();
+}
+
+bool HistoryStore::SetSpillFile(const std::string& path, long long threshold) {
+  //truncating the file could cut it under the chunks mapped from it
+  if (spill_chunks_ > 0)
+    return false;
+  CloseSpill();
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+  spill_fd_ = fd;
+  spill_threshold_ = threshold;
+  spill_chunks_ = 0;
+  return true;
+}
+
+void HistoryStore::CloseSpill() {
+  //mapped chunks stay valid after the descriptor is closed
+  if (spill_fd_ >= 0)
+    ::close(spill_fd_);
+  spill_fd_ = -1;
+}
+
+void HistoryStore::AddChunk() {
+  Chunk chunk;
+  chunk.data = NULL;
+  chunk.mapped = false;
+
+  if (spill_fd_ >= 0 && size_ >= spill_threshold_) {
+    //grow the file by one chunk and map it; chunks are page multiples so
+    //every offset is page aligned
+    const off_t offset = spill_chunks_ * kChunkBytes;
+    if (::ftruncate(spill_fd_, offset + kChunkBytes) == 0) {
+      void* data = ::mmap(NULL, kChunkBytes, PROT_READ | PROT_WRITE, MAP_SHARED, spill_fd_, offset);
+      if (data != MAP_FAILED) {
+        chunk.data = static_cast<double*>(data);
+        chunk.mapped = true;
+        spill_chunks_++;
+      }
+    }
+  }
+  if (!chunk.data)
+    chunk.data = new double[kColumns * kChunkRows];
+  chunks_.push_back(chunk);
+}
+
+void HistoryStore::Append(long long timestamp, int target, const double estimate[4], const double truth[4]) {
+  if (size_ == (long long)chunks_.size() * kChunkRows)
+    AddChunk();
+  double* data = chunks_.back().data;
+  const int row = size_ % kChunkRows;
+  data[kTimestamp * kChunkRows + row] = timestamp;
+  data[kTarget * kChunkRows + row] = target;
+  for (int i = 0; i < 4; i++) {
+    data[(kEstPx + i) * kChunkRows + row] = estimate[i];
+    data[(kTruePx + i) * kChunkRows + row] = truth[i];
+  }
+  size_++;
+}
+
+void HistoryStore::FreeChunks() {
+  for (size_t c = 0; c < chunks_.size(); c++) {
+    if (chunks_[c].mapped)
+      ::munmap(chunks_[c].data, kChunkBytes);
+    else
+      delete[] chunks_[c].data;
+  }
+  chunks_.clear();
+  size_ = 0;
+}
+
+void HistoryStore::Clear() {
+  FreeChunks();
+
+  //start the spill file over
+  if (spill_fd_ >= 0 && ::ftruncate(spill_fd_, 0) != 0)
+    CloseSpill();
+  spill_chunks_ = 0;
+}
+
+int HistoryStore::chunk_rows(int c) const {
+  const long long rows = size_ - (long long)c * kChunkRows;
+  return rows < kChunkRows ? (int)rows : kChunkRows;
+}
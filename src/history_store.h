@@ -0,0 +1,102 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Columnar record of evaluated estimates and their ground truth.
+ *
+ * Rows are stored in fixed-size chunks of kChunkRows, each chunk one block
+ * of kColumns contiguous double arrays, so a pass over one column streams
+ * through memory and appending never moves existing rows. Once a spill file
+ * is set and the store reaches its threshold, further chunks are mapped from
+ * that file instead of allocated, which bounds the heap allocation of long
+ * runs. Mapped pages stay resident until the kernel writes them back.
+ */
+class HistoryStore {
+ public:
+  enum Column {
+    kTimestamp,
+    kTarget,
+    kEstPx, kEstPy, kEstVx, kEstVy,
+    kTruePx, kTruePy, kTrueVx, kTrueVy,
+    kColumns
+  };
+
+  // rows per chunk; a chunk is a whole number of pages
+  static const int kChunkRows = 4096;
+
+  HistoryStore();
+
+  /**
+   * Destructor, frees the chunks and closes the spill file
+   */
+  ~HistoryStore();
+
+  /**
+   * Spills every chunk started after the store holds threshold rows to a
+   * memory-mapped file at path, which is created or truncated. If the file
+   * cannot grow later the store keeps allocating in memory. Once chunks are
+   * mapped from a spill file the setting is fixed until Clear, since the
+   * new path may be the same file.
+   * @param {string} path: spill file
+   * 		  {long long} threshold: rows kept in memory
+   * @return false if the file cannot be opened or chunks are mapped
+   */
+  bool SetSpillFile(const std::string& path, long long threshold);
+
+  /**
+   * Appends one row.
+   * @param {long long} timestamp: time of the estimate, in us
+   * 		  {int} target: index of the tracked target
+   * 		  {const double[4]} estimate: estimated [px py vx vy]
+   * 		  {const double[4]} truth: ground truth [px py vx vy]
+   */
+  void Append(long long timestamp, int target, const double estimate[4], const double truth[4]);
+
+  /**
+   * Drops every row, keeping the spill file setting.
+   */
+  void Clear();
+
+  long long size() const { return size_; }
+
+  int chunk_count() const { return chunks_.size(); }
+
+  // rows in chunk c, kChunkRows for all but the last chunk
+  int chunk_rows(int c) const;
+
+  // values of col in chunk c, chunk_rows(c) of them
+  const double* column(int c, Column col) const {
+    return chunks_[c].data + col * kChunkRows;
+  }
+
+ private:
+  HistoryStore(const HistoryStore&);
+  HistoryStore& operator=(const HistoryStore&);
+
+  struct Chunk {
+    double* data;
+    // mapped from the spill file rather than allocated
+    bool mapped;
+  };
+
+  // adds an empty chunk, from the spill file once past the threshold
+  void AddChunk();
+
+  // unmaps or frees every chunk
+  void FreeChunks();
+
+  void CloseSpill();
+
+  std::vector<Chunk> chunks_;
+  long long size_;
+
+  long long spill_threshold_;
+  int spill_fd_;
+  // chunks the spill file holds
+  long long spill_chunks_;
+};
+
+#endif  // HISTORY_STORE_H
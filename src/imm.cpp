@@ -0,0 +1,25 @@
+#include "imm.h"
+
+template class UKFFixed<6, 8, double, double, sigma::Symmetric, motion::CV>;
+template class UKFFixed<6, 8, double, double, sigma::Symmetric, motion::CTRV>;
+template class UKFFixed<6, 8, double, double, sigma::Symmetric, motion::CTRA>;
+template class IMM<CVFilter, CTRVFilter, CTRAFilter>;
+
+/**
+ * Initializes the CV/CTRV/CTRA tracker
+ */
+IMMTracker::IMMTracker() {
+  // cruising: little acceleration, the heading barely moves
+  Model<0>().std_a_ = 0.3;
+  Model<0>().std_yawdd_ = 0.05;
+
+  // steady turns: the single-model UKF tuning
+  Model<1>().std_a_ = 0.7;
+  Model<1>().std_yawdd_ = 0.9;
+
+  // speeding up and braking: std_a_ is the longitudinal jerk in m/s^3
+  Model<2>().std_a_ = 1.5;
+  Model<2>().std_yawdd_ = 0.5;
+}
+
+IMMTracker::~IMMTracker() {}
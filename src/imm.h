@@ -0,0 +1,492 @@
+#ifndef IMM_H
+#define IMM_H
+
+#include "Eigen/Dense"
+#include "measurement_package.h"
+#include "state_snapshot.h"
+#include "thread_pool.h"
+#include "ukf_fixed.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace imm_internal {
+
+/**
+ * Calls f(i, model) for every model of a tuple, or for model m only.
+ */
+template <int I, int M>
+struct ForModels {
+  template <class Tuple, class F>
+  static void All(Tuple& models, F& f) {
+    f(I, std::get<I>(models));
+    ForModels<I + 1, M>::All(models, f);
+  }
+
+  template <class Tuple, class F>
+  static void One(Tuple& models, int m, F& f) {
+    if (m == I)
+      f(I, std::get<I>(models));
+    else
+      ForModels<I + 1, M>::One(models, m, f);
+  }
+};
+
+template <int M>
+struct ForModels<M, M> {
+  template <class Tuple, class F>
+  static void All(Tuple&, F&) {}
+
+  template <class Tuple, class F>
+  static void One(Tuple&, int, F&) {}
+};
+
+}  // namespace imm_internal
+
+/**
+ * Interacting Multiple Model estimator over UKFFixed filters that share one
+ * state layout and differ in their motion model (see motion_models.h).
+ *
+ * Every cycle, one measurement or one same-timestamp batch:
+ *  - BeginCycle mixes: each model restarts from a blend of all model states,
+ *    weighted by the Markov transition matrix and the model probabilities,
+ *  - FilterModel runs the predict/update of one model filter,
+ *  - EndCycle weights the models by their measurement likelihoods and
+ *    blends their states into x_ and P_.
+ * The model states are gathered as the columns of one matrix and the
+ * covariances as flattened columns of another, so mixing and blending are
+ * matrix products across all models. The model filters of one cycle are
+ * independent, ProcessTracks runs them in parallel across tracks and models.
+ *
+ * Like UKFFixed, the blended state is published to published_ after every
+ * cycle and StateAt.
+ *
+ * The model filters keep no out-of-sequence history, a measurement older
+ * than time_us_ is dropped.
+ */
+template <class... Filters>
+class IMM {
+ public:
+  typedef std::tuple<Filters...> Models;
+  typedef typename std::tuple_element<0, Models>::type First;
+
+  // Number of models
+  static const int n_models_ = sizeof...(Filters);
+
+  // State dimension, shared by all models
+  static const int n_x_ = First::n_x_;
+
+  typedef Eigen::Matrix<double, n_x_, 1, Eigen::DontAlign> StateVector;
+  typedef Eigen::Matrix<double, n_x_, n_x_, Eigen::DontAlign> StateMatrix;
+  typedef Eigen::Matrix<double, n_models_, 1, Eigen::DontAlign> ModelVector;
+  typedef Eigen::Matrix<double, n_models_, n_models_, Eigen::DontAlign> ModelMatrix;
+
+  // model states as columns, covariances as column-major flattened columns
+  typedef Eigen::Matrix<double, n_x_, n_models_, Eigen::DontAlign> ModelStates;
+  typedef Eigen::Matrix<double, n_x_ * n_x_, n_models_, Eigen::DontAlign> ModelCovariances;
+  typedef StateSnapshot<n_x_> Snapshot;
+
+  /**
+   * Constructor
+   */
+  IMM();
+
+  /**
+   * Destructor
+   */
+  virtual ~IMM() {}
+
+  /**
+   * ProcessMeasurement
+   * @param meas_package The latest measurement data of either radar or laser
+   */
+  void ProcessMeasurement(const MeasurementPackage& meas_package);
+
+  /**
+   * Processes measurements in order, each run of consecutive measurements
+   * that share a timestamp as one cycle, see UKFFixed::ProcessMeasurements.
+   * @param {const MeasurementPackage*} meas_packages:measurements
+   * 		  {int} n:number of measurements
+   */
+  void ProcessMeasurements(const MeasurementPackage* meas_packages, int n);
+
+  /**
+   * Runs one cycle on each of n_tracks trackers, with the model filters of
+   * all trackers spread over the pool.
+   * @param {IMM*} tracks: n_tracks trackers
+   * 		  {const MeasurementPackage* const*} meas_packages: batch of each
+   * 		  track, all with the same timestamp
+   * 		  {const int*} counts: size of each batch, 0 skips the track
+   * 		  {ThreadPool*} pool: threads to run on
+   */
+  static void ProcessTracks(IMM* tracks, int n_tracks, const MeasurementPackage* const* meas_packages,
+                            const int* counts, ThreadPool* pool);
+
+  /**
+   * Moves every model to timestamp, runs their pending predictions and
+   * blends them, see UKFFixed::StateAt.
+   * @param {long long} timestamp: time in us, not older than time_us_
+   * @return x_
+   */
+  const StateVector& StateAt(long long timestamp);
+
+  /**
+   * Model filter I, for tuning.
+   */
+  template <int I>
+  typename std::tuple_element<I, Models>::type& Model() {
+    return std::get<I>(models_);
+  }
+
+  /**
+   * Starts a cycle: drops a late batch, otherwise mixes the model states.
+   * @return false if the batch is dropped
+   */
+  bool BeginCycle(const MeasurementPackage* meas_packages, int n);
+
+  /**
+   * Runs the batch of the current cycle through model m.
+   */
+  void FilterModel(int m, const MeasurementPackage* meas_packages, int n);
+
+  /**
+   * Ends a cycle: updates the model probabilities and blends x_ and P_.
+   */
+  void EndCycle();
+
+  /**
+   * Reads the states, covariances and likelihoods of all models.
+   */
+  void Gather();
+
+  /**
+   * Publishes x_, P_ and the time they are true to published_.
+   */
+  void Publish();
+
+  /**
+   * Blends K sets of model states: column k of W weights the models for
+   * output k. Yaw is blended relative to model 0 so the weights never
+   * average across the +-pi cut.
+   * @param {ModelStates} X: model states
+   * 		  {ModelCovariances} P: model covariances
+   * 		  {Matrix} W: n_models_ x K weights, columns summing to 1
+   * 		  {Matrix*} Xb: K blended states
+   * 		  {Matrix*} Pb: K blended covariances including the spread of
+   * 		  the states
+   */
+  template <int K>
+  static void Blend(const ModelStates& X, const ModelCovariances& P,
+                    const Eigen::Matrix<double, n_models_, K, Eigen::DontAlign>& W,
+                    Eigen::Matrix<double, n_x_, K, Eigen::DontAlign>* Xb,
+                    Eigen::Matrix<double, n_x_ * n_x_, K, Eigen::DontAlign>* Pb);
+
+  // initially set to false, set to true after the first cycle
+  bool is_initialized_;
+
+  // time of the blended state, in us
+  long long time_us_;
+
+  // blended state vector, same layout as the model states
+  StateVector x_;
+
+  // blended state covariance matrix
+  StateMatrix P_;
+
+  // model probabilities
+  ModelVector mu_;
+
+  // Markov transition matrix, entry (i, j) is the probability of switching
+  // from model i to model j between two cycles; entries must be positive
+  ModelMatrix transition_;
+
+  // the model filters
+  Models models_;
+
+  // predicted model probabilities of the current cycle
+  ModelVector c_bar_;
+
+  // true while the current cycle processes its batch
+  bool active_;
+
+  // gathered model states, covariances and log likelihoods
+  ModelStates X_;
+  ModelCovariances P_models_;
+  ModelVector log_likelihood_;
+
+  // mixed model states and covariances
+  ModelStates X_mixed_;
+  ModelCovariances P_mixed_;
+
+  // last published blended state, for readers on other threads
+  SnapshotPublisher<Snapshot> published_;
+
+ private:
+  // functors over the heterogeneous model filters
+  struct GatherModel {
+    IMM* imm;
+    template <class F>
+    void operator()(int m, F& f) {
+      imm->X_.col(m) = f.x_.template cast<double>();
+      Eigen::Map<StateMatrix>(imm->P_models_.col(m).data()) = f.P_.template cast<double>();
+      imm->log_likelihood_(m) = f.log_likelihood_;
+    }
+  };
+
+  struct ScatterModel {
+    IMM* imm;
+    template <class F>
+    void operator()(int m, F& f) {
+      typedef typename F::Scalar Scalar;
+      f.SetState(imm->X_mixed_.col(m).template cast<Scalar>(),
+                 Eigen::Map<const StateMatrix>(imm->P_mixed_.col(m).data()).template cast<Scalar>());
+      f.log_likelihood_ = 0;
+    }
+  };
+
+  struct RunModel {
+    const MeasurementPackage* meas_packages;
+    int n;
+    template <class F>
+    void operator()(int, F& f) {
+      f.ProcessMeasurements(meas_packages, n);
+    }
+  };
+
+  struct MoveModel {
+    long long timestamp;
+    template <class F>
+    void operator()(int, F& f) {
+      f.StateAt(timestamp);
+    }
+  };
+
+  // blends x_ and P_ from the gathered model states with weights mu_
+  void CombineStates();
+
+  typedef imm_internal::ForModels<0, n_models_> ForModels;
+};
+
+template <class... Filters>
+IMM<Filters...>::IMM() {
+  is_initialized_ = false;
+  time_us_ = 0;
+  active_ = false;
+
+  x_.setZero();
+  P_.setZero();
+
+  // all models equally likely, each stays with probability 0.95 per cycle
+  mu_.setConstant(1.0 / n_models_);
+  if (n_models_ > 1)
+    transition_.setConstant(0.05 / (n_models_ - 1));
+  transition_.diagonal().setConstant(n_models_ > 1 ? 0.95 : 1.0);
+  c_bar_ = mu_;
+}
+
+template <class... Filters>
+void IMM<Filters...>::ProcessMeasurement(const MeasurementPackage& meas_package) {
+  ProcessMeasurements(&meas_package, 1);
+}
+
+template <class... Filters>
+void IMM<Filters...>::ProcessMeasurements(const MeasurementPackage* meas_packages, int n) {
+  for (int i = 0; i < n;) {
+    int end = i + 1;
+    while (end < n && meas_packages[end].timestamp_ == meas_packages[i].timestamp_)
+      end++;
+    if (BeginCycle(meas_packages + i, end - i)) {
+      for (int m = 0; m < n_models_; m++)
+        FilterModel(m, meas_packages + i, end - i);
+      EndCycle();
+    }
+    i = end;
+  }
+}
+
+template <class... Filters>
+void IMM<Filters...>::ProcessTracks(IMM* tracks, int n_tracks, const MeasurementPackage* const* meas_packages,
+                                    const int* counts, ThreadPool* pool) {
+  pool->ParallelFor(n_tracks, [=](int begin, int end) {
+    for (int t = begin; t < end; t++)
+      tracks[t].BeginCycle(meas_packages[t], counts[t]);
+  });
+
+  //every (track, model) pair is independent until the end of the cycle
+  pool->ParallelFor(n_tracks * n_models_, [=](int begin, int end) {
+    for (int k = begin; k < end; k++) {
+      const int t = k / n_models_;
+      tracks[t].FilterModel(k % n_models_, meas_packages[t], counts[t]);
+    }
+  });
+
+  pool->ParallelFor(n_tracks, [=](int begin, int end) {
+    for (int t = begin; t < end; t++)
+      tracks[t].EndCycle();
+  });
+}
+
+template <class... Filters>
+bool IMM<Filters...>::BeginCycle(const MeasurementPackage* meas_packages, int n) {
+  active_ = false;
+  if (n <= 0)
+    return false;
+
+  //the first cycle initializes every model from the same measurement
+  if (!is_initialized_) {
+    c_bar_ = mu_;
+    active_ = true;
+    return true;
+  }
+
+  //out of sequence: the models keep no history, drop it
+  if (meas_packages[0].timestamp_ < time_us_)
+    return false;
+
+  //predicted model probabilities and the mixing weights
+  //W(i, j) = transition(i, j) * mu(i) / c_bar(j)
+  c_bar_.noalias() = transition_.transpose() * mu_;
+  ModelMatrix W = mu_.asDiagonal() * transition_;
+  W = W * c_bar_.cwiseInverse().asDiagonal();
+
+  Gather();
+  Blend<n_models_>(X_, P_models_, W, &X_mixed_, &P_mixed_);
+
+  ScatterModel scatter = {this};
+  ForModels::All(models_, scatter);
+
+  active_ = true;
+  return true;
+}
+
+template <class... Filters>
+void IMM<Filters...>::FilterModel(int m, const MeasurementPackage* meas_packages, int n) {
+  if (!active_)
+    return;
+  RunModel run = {meas_packages, n};
+  ForModels::One(models_, m, run);
+}
+
+template <class... Filters>
+void IMM<Filters...>::EndCycle() {
+  if (!active_)
+    return;
+  active_ = false;
+
+  Gather();
+
+  //mu(j) proportional to c_bar(j) * likelihood(j), scaled by the largest
+  //likelihood before exponentiating
+  const double max_log = log_likelihood_.maxCoeff();
+  for (int m = 0; m < n_models_; m++)
+    mu_(m) = c_bar_(m) * std::exp(log_likelihood_(m) - max_log);
+  mu_ /= mu_.sum();
+
+  CombineStates();
+  time_us_ = std::get<0>(models_).time_us_;
+  is_initialized_ = true;
+  Publish();
+}
+
+template <class... Filters>
+const typename IMM<Filters...>::StateVector& IMM<Filters...>::StateAt(long long timestamp) {
+  MoveModel move = {timestamp};
+  ForModels::All(models_, move);
+
+  Gather();
+  CombineStates();
+  time_us_ = timestamp;
+  Publish();
+  return x_;
+}
+
+template <class... Filters>
+void IMM<Filters...>::Publish() {
+  //the models share one clock, model 0 tells when the blend is true
+  const First& model = std::get<0>(models_);
+  Snapshot snapshot;
+  snapshot.timestamp = model.time_us_ - (long long)std::llround(model.pending_dt_ * 1000000.0);
+  snapshot.x = x_;
+  snapshot.P = P_;
+  published_.Publish(snapshot);
+}
+
+template <class... Filters>
+void IMM<Filters...>::Gather() {
+  GatherModel gather = {this};
+  ForModels::All(models_, gather);
+}
+
+template <class... Filters>
+void IMM<Filters...>::CombineStates() {
+  StateVector x;
+  Eigen::Matrix<double, n_x_ * n_x_, 1, Eigen::DontAlign> P;
+  Blend<1>(X_, P_models_, mu_, &x, &P);
+  x_ = x;
+  P_ = Eigen::Map<const StateMatrix>(P.data());
+}
+
+template <class... Filters>
+template <int K>
+void IMM<Filters...>::Blend(const ModelStates& X, const ModelCovariances& P,
+                            const Eigen::Matrix<double, n_models_, K, Eigen::DontAlign>& W,
+                            Eigen::Matrix<double, n_x_, K, Eigen::DontAlign>* Xb,
+                            Eigen::Matrix<double, n_x_ * n_x_, K, Eigen::DontAlign>* Pb) {
+
+  //model states relative to model 0, yaw wrapped to [-pi, pi]
+  ModelStates D = X.colwise() - X.col(0);
+  for (int m = 0; m < n_models_; m++) {
+    while (D(3,m)> M_PI) D(3,m)-=2.*M_PI;
+    while (D(3,m)<-M_PI) D(3,m)+=2.*M_PI;
+  }
+
+  //blended means and covariances, one product each
+  Eigen::Matrix<double, n_x_, K, Eigen::DontAlign> Db;
+  Db.noalias() = D * W;
+  Pb->noalias() = P * W;
+
+  //spread of the model states around each blended mean
+  for (int k = 0; k < K; k++) {
+    Eigen::Map<StateMatrix> Pk(Pb->col(k).data());
+    for (int m = 0; m < n_models_; m++) {
+      const StateVector d = D.col(m) - Db.col(k);
+      Pk.noalias() += W(m,k) * d * d.transpose();
+    }
+  }
+
+  *Xb = Db.colwise() + X.col(0);
+  for (int k = 0; k < K; k++) {
+    while ((*Xb)(3,k)> M_PI) (*Xb)(3,k)-=2.*M_PI;
+    while ((*Xb)(3,k)<-M_PI) (*Xb)(3,k)+=2.*M_PI;
+  }
+}
+
+/**
+ * CV, CTRV and CTRA over the common state [px py v yaw yawd a], with the
+ * noise of each model tuned for its regime: CV for cruising, CTRV for
+ * steady turns and CTRA for speeding up or braking.
+ */
+typedef UKFFixed<6, 8, double, double, sigma::Symmetric, motion::CV> CVFilter;
+typedef UKFFixed<6, 8, double, double, sigma::Symmetric, motion::CTRV> CTRVFilter;
+typedef UKFFixed<6, 8, double, double, sigma::Symmetric, motion::CTRA> CTRAFilter;
+
+class IMMTracker : public IMM<CVFilter, CTRVFilter, CTRAFilter> {
+ public:
+  /**
+   * Constructor
+   */
+  IMMTracker();
+
+  /**
+   * Destructor
+   */
+  virtual ~IMMTracker();
+};
+
+// compiled once in imm.cpp
+extern template class UKFFixed<6, 8, double, double, sigma::Symmetric, motion::CV>;
+extern template class UKFFixed<6, 8, double, double, sigma::Symmetric, motion::CTRV>;
+extern template class UKFFixed<6, 8, double, double, sigma::Symmetric, motion::CTRA>;
+extern template class IMM<CVFilter, CTRVFilter, CTRAFilter>;
+
+#endif  // IMM_H
@@ -5,6 +5,13 @@
 
 class MeasurementPackage {
 public:
+  // most components a measurement can carry
+  static const int kMaxSize = 6;
+
+  // measurement vector with inline storage: resizing up to kMaxSize and
+  // copying never touch the heap
+  typedef Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::DontAlign, kMaxSize, 1> MeasurementVector;
+
   long timestamp_;
 
   enum SensorType{
@@ -12,8 +19,8 @@ public:
     RADAR
   } sensor_type_;
 
-  Eigen::VectorXd raw_measurements_;
+  MeasurementVector raw_measurements_;
 
 };
 
-#endif /* MEASUREMENT_PACKAGE_H_ */
\ No newline at end of file
+#endif /* MEASUREMENT_PACKAGE_H_ */
@@ -0,0 +1,155 @@
+#ifndef MOTION_MODELS_H
+#define MOTION_MODELS_H
+
+#include "ctrv_kernel.h"
+#include "simd_math.h"
+
+/**
+ * Process models consumed by UKFFixed::SigmaPointPrediction.
+ *
+ * A model moves the first n_core state components and is driven by two
+ * noise terms, the last two rows of the augmented state; state components
+ * past n_core are carried through unchanged. It provides
+ *  - n_core: number of state components it moves,
+ *  - Propagate(in, d, out): one pack of sigma points, in holds the n_core
+ *    state rows then the two noise rows, out the n_core predicted rows.
+ * Like ctrv_kernel.h, Propagate is written once over the SIMD pack type.
+ *
+ * All three models share the state layout [px py v yaw yawd a], so an IMM
+ * can mix their states directly: CV and CTRV ignore the components they do
+ * not model and carry them unchanged.
+ */
+namespace motion {
+
+/**
+ * Constant turn rate and velocity, noise [nu_a, nu_yawdd].
+ */
+struct CTRV {
+  static const int n_core = 5;
+
+  template <class V>
+  static void Propagate(const V in[7], V d, V out[5]) {
+    ctrv::Propagate(in, d, out);
+  }
+};
+
+/**
+ * Constant velocity along the heading, noise [nu_a, nu_yawdd]. The yaw rate
+ * only picks up noise and does not turn the heading.
+ */
+struct CV {
+  static const int n_core = 5;
+
+  template <class V>
+  static void Propagate(const V in[7], V d, V out[5]) {
+    const V p_x = in[0], p_y = in[1], v = in[2], yaw = in[3], yawd = in[4];
+    const V nu_a = in[5], nu_yawdd = in[6];
+
+    V s0, c0;
+    simd_math::SinCos(yaw, &s0, &c0);
+
+    const V half_dd = V(0.5) * d * d;
+    const V vd = v * d;
+    out[0] = p_x + (vd + half_dd * nu_a) * c0;
+    out[1] = p_y + (vd + half_dd * nu_a) * s0;
+    out[2] = v + nu_a * d;
+    out[3] = yaw + half_dd * nu_yawdd;
+    out[4] = yawd + nu_yawdd * d;
+  }
+};
+
+/**
+ * Constant turn rate and acceleration, state [px py v yaw yawd a], noise
+ * [nu_j, nu_yawdd] where nu_j is the longitudinal jerk. The near-zero yaw
+ * rate case is blended in like in CTRV. The turning case is written with a
+ * single division by yawd, (v1*s1 - v*s0 - a*q*sin(yaw+h))/yawd with
+ * h = yawd*d/2 and q = 2*sin(h)/yawd, instead of the textbook 1/yawd^2 form
+ * that cancels catastrophically in float.
+ */
+struct CTRA {
+  static const int n_core = 6;
+
+  template <class V>
+  static void Propagate(const V in[8], V d, V out[6]) {
+    const V p_x = in[0], p_y = in[1], v = in[2], yaw = in[3], yawd = in[4], a = in[5];
+    const V nu_j = in[6], nu_yawdd = in[7];
+
+    V s0, c0, s1, c1, sh, ch;
+    const V yaw1 = yaw + yawd * d;
+    const V v1 = v + a * d;
+    simd_math::SinCos(yaw, &s0, &c0);
+    simd_math::SinCos(yaw1, &s1, &c1);
+
+    //avoid division by zero: straight line where |yawd| <= 0.001
+    typename V::Mask turning = simd_math::Abs(yawd) > V(0.001);
+    const V w = simd_math::Select(turning, yawd, V(1.0));
+    simd_math::SinCos(V(0.5) * w * d, &sh, &ch);
+    const V aq = a * V(2.0) * sh / w;
+    const V sm = s0 * ch + c0 * sh;
+    const V cm = c0 * ch - s0 * sh;
+    const V dist = v * d + V(0.5) * a * d * d;
+    const V dx = simd_math::Select(turning, (v1 * s1 - v * s0 - aq * sm) / w, dist * c0);
+    const V dy = simd_math::Select(turning, (v * c0 - v1 * c1 + aq * cm) / w, dist * s0);
+
+    //add noise
+    const V half_dd = V(0.5) * d * d;
+    const V sixth_ddd = half_dd * d * V(1.0 / 3.0);
+    out[0] = p_x + dx + sixth_ddd * nu_j * c0;
+    out[1] = p_y + dy + sixth_ddd * nu_j * s0;
+    out[2] = v1 + half_dd * nu_j;
+    out[3] = yaw1 + half_dd * nu_yawdd;
+    out[4] = yawd + nu_yawdd * d;
+    out[5] = a + nu_j * d;
+  }
+};
+
+namespace internal {
+
+template <class Model, class V, typename T>
+inline void PredictAt(const T* const Xaug[], T* const Xpred[], V d, int i) {
+  V in[Model::n_core + 2], out[Model::n_core];
+  for (int r = 0; r < Model::n_core + 2; r++)
+    in[r] = V::Load(Xaug[r] + i);
+  Model::Propagate(in, d, out);
+  for (int r = 0; r < Model::n_core; r++)
+    out[r].Store(Xpred[r] + i);
+}
+
+}  // namespace internal
+
+/**
+ * Propagates n lanes of augmented sigma points by delta_t through Model.
+ * @param {const T* const[]} Xaug: Model::n_core state rows, then the two
+ * 		  noise rows
+ * 		  {T* const[]} Xpred: Model::n_core rows of the result
+ * 		  {double} delta_t: time step in s, shared by all lanes
+ * 		  {int} n: number of lanes
+ */
+template <class Model, typename T>
+inline void PredictSigmaPoints(const T* const Xaug[], T* const Xpred[], double delta_t, int n) {
+  typedef typename simd_math::Lanes<T>::Vec Vec;
+  typedef typename simd_math::Lanes<T>::One One;
+  int i = 0;
+  for (; i + Vec::kWidth <= n; i += Vec::kWidth)
+    internal::PredictAt<Model>(Xaug, Xpred, Vec(delta_t), i);
+  for (; i < n; i++)
+    internal::PredictAt<Model>(Xaug, Xpred, One(delta_t), i);
+}
+
+/**
+ * Same as above with a time step per lane.
+ */
+template <class Model, typename T>
+inline void PredictSigmaPoints(const T* const Xaug[], T* const Xpred[], const T* delta_t, int n) {
+  typedef typename simd_math::Lanes<T>::Vec Vec;
+  typedef typename simd_math::Lanes<T>::One One;
+  int i = 0;
+  for (; i + Vec::kWidth <= n; i += Vec::kWidth)
+    internal::PredictAt<Model>(Xaug, Xpred, Vec::Load(delta_t + i), i);
+  for (; i < n; i++)
+    internal::PredictAt<Model>(Xaug, Xpred, One::Load(delta_t + i), i);
+}
+
+}  // namespace motion
+
+#endif  // MOTION_MODELS_H
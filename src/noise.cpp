@@ -0,0 +1,93 @@
+#include "noise.h"
+#include "simd_math.h"
+#include <algorithm>
+#include <cmath>
+
+void rng::Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]) {
+  const uint64_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+  const uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < 10; round++) {
+    const uint64_t p0 = M0 * c0;
+    const uint64_t p1 = M1 * c2;
+    const uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+    const uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+    c1 = uint32_t(p1);
+    c3 = uint32_t(p0);
+    c0 = n0;
+    c2 = n2;
+    k0 += W0;
+    k1 += W1;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+rng::NoiseService::NoiseService(uint64_t seed) {
+  key_[0] = uint32_t(seed);
+  key_[1] = uint32_t(seed >> 32);
+}
+
+void rng::NoiseService::Normal(long long timestamp, uint32_t channel, double* out, int n) const {
+  typedef simd_math::Pack Pack;
+  typedef simd_math::Scalar Scalar;
+
+  // Box-Muller pairs per chunk, a multiple of every pack width
+  const int kPairs = 32;
+  double u1[kPairs], u2[kPairs], r[kPairs], s[kPairs], c[kPairs];
+
+  const uint64_t t = timestamp;
+  uint32_t counter[4] = {0, channel, uint32_t(t), uint32_t(t >> 32)};
+  uint32_t bits[4];
+
+  for (int first = 0; first < (n + 1) / 2; first += kPairs) {
+    const int pairs = std::min(kPairs, (n + 1) / 2 - first);
+
+    //two pairs per Philox block, uniforms in (0, 1)
+    for (int i = 0; i < pairs; i++) {
+      const int pair = first + i;
+      if (i == 0 || pair % 2 == 0) {
+        counter[0] = pair / 2;
+        Philox4x32(counter, key_, bits);
+      }
+      const int w = 2 * (pair % 2);
+      u1[i] = (bits[w] + 0.5) * (1.0 / 4294967296.0);
+      u2[i] = (bits[w+1] + 0.5) * (1.0 / 4294967296.0);
+    }
+
+    //radius sqrt(-2 log u1) and angle 2 pi u2
+    int i = 0;
+    for (; i + Pack::kWidth <= pairs; i += Pack::kWidth) {
+      Pack ps, pc;
+      simd_math::Sqrt(Pack(-2.0) * simd_math::Log(Pack::Load(u1 + i))).Store(r + i);
+      simd_math::SinCos(Pack(2.0 * M_PI) * Pack::Load(u2 + i), &ps, &pc);
+      ps.Store(s + i);
+      pc.Store(c + i);
+    }
+    for (; i < pairs; i++) {
+      Scalar ps, pc;
+      r[i] = simd_math::Sqrt(Scalar(-2.0) * simd_math::Log(Scalar(u1[i]))).v;
+      simd_math::SinCos(Scalar(2.0 * M_PI) * Scalar(u2[i]), &ps, &pc);
+      s[i] = ps.v;
+      c[i] = pc.v;
+    }
+
+    //pair p gives samples 2p and 2p+1
+    for (int i = 0; i < pairs; i++) {
+      const int k = 2 * (first + i);
+      out[k] = r[i] * c[i];
+      if (k + 1 < n)
+        out[k+1] = r[i] * s[i];
+    }
+  }
+}
+
+double rng::NoiseService::Normal(long long timestamp, uint32_t channel, double stddev) const {
+  double sample;
+  Normal(timestamp, channel, &sample, 1);
+  return stddev * sample;
+}
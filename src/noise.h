@@ -0,0 +1,57 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <stdint.h>
+
+/**
+ * Counter-based random numbers for the sensor simulation.
+ *
+ * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+ * 3") maps a 128-bit counter and a 64-bit key to 128 random bits with ten
+ * multiply/xor rounds and no state. NoiseService keys it with a seed and
+ * puts (timestamp, channel, block) in the counter, so any sample of any
+ * timestamp can be drawn directly, in any order and on any thread, and a
+ * run is reproduced exactly from its seed.
+ */
+namespace rng {
+
+/**
+ * One Philox4x32-10 block.
+ * @param {const uint32_t[4]} counter: block counter
+ * 		  {const uint32_t[2]} key: key
+ * 		  {uint32_t[4]} out: 128 random bits
+ */
+void Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+class NoiseService {
+ public:
+  /**
+   * Constructor
+   * @param {uint64_t} seed: key of every stream drawn from this service
+   */
+  explicit NoiseService(uint64_t seed = 0);
+
+  /**
+   * Standard normal samples 0..n-1 of the stream (timestamp, channel).
+   * Sample i does not depend on n. Uniforms come from Philox, two 32-bit
+   * words per Box-Muller pair, and the transform runs on the SIMD packs of
+   * simd_math.h.
+   * @param {long long} timestamp: time of the samples, in us
+   * 		  {uint32_t} channel: independent stream at the same time
+   * 		  {double*} out: n samples
+   * 		  {int} n: number of samples
+   */
+  void Normal(long long timestamp, uint32_t channel, double* out, int n) const;
+
+  /**
+   * Sample 0 of the stream (timestamp, channel), scaled by stddev.
+   */
+  double Normal(long long timestamp, uint32_t channel, double stddev) const;
+
+ private:
+  uint32_t key_[2];
+};
+
+}  // namespace rng
+
+#endif  // NOISE_H
@@ -20,6 +20,33 @@ void renderHighway(double distancePos, pcl::visualization::PCLVisualizer::Ptr& v
 	viewer->addLine(pcl::PointXYZ(roadLengthBehind, roadWidth / 6, 0.01), pcl::PointXYZ(roadLengthAhead, roadWidth / 6, 0.01), 1, 1, 0, "line2");
 
 	// render poles
+	std::vector<Box> poles = highwayPoles(distancePos);
+	for(int poleIndex = 0; poleIndex < (int)poles.size()/2; poleIndex++)
+	{
+		//	left pole
+		const Box& l = poles[2*poleIndex];
+		viewer->addCube(l.x_min, l.x_max, l.y_min, l.y_max, l.z_min, l.z_max, 1, 0.5, 0, "pole_"+std::to_string(poleIndex)+"l");
+		viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_REPRESENTATION, pcl::visualization::PCL_VISUALIZER_REPRESENTATION_SURFACE, "pole_"+std::to_string(poleIndex)+"l");
+		viewer->addCube(l.x_min, l.x_max, l.y_min, l.y_max, l.z_min, l.z_max, 0, 0, 0, "pole_"+std::to_string(poleIndex)+"lframe");
+		viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_REPRESENTATION, pcl::visualization::PCL_VISUALIZER_REPRESENTATION_WIREFRAME, "pole_"+std::to_string(poleIndex)+"lframe");
+
+		//	right pole
+		const Box& r = poles[2*poleIndex+1];
+		viewer->addCube(r.x_min, r.x_max, r.y_min, r.y_max, r.z_min, r.z_max, 1, 0.5, 0, "pole_"+std::to_string(poleIndex)+"r");
+		viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_REPRESENTATION, pcl::visualization::PCL_VISUALIZER_REPRESENTATION_SURFACE, "pole_"+std::to_string(poleIndex)+"r");
+		viewer->addCube(r.x_min, r.x_max, r.y_min, r.y_max, r.z_min, r.z_max, 0, 0, 0, "pole_"+std::to_string(poleIndex)+"rframe");
+		viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_REPRESENTATION, pcl::visualization::PCL_VISUALIZER_REPRESENTATION_WIREFRAME, "pole_"+std::to_string(poleIndex)+"rframe");
+	}
+
+}
+
+std::vector<Box> highwayPoles(double distancePos)
+{
+	// units in meters
+	double roadLengthAhead = 50.0;
+	double roadLengthBehind = -15.0;
+	double roadWidth = 12.0;
+
 	// spacing in meters between poles, poles start at x = 0
 	double poleSpace = 10;
 	// pole distance from road curve
@@ -27,29 +54,26 @@ void renderHighway(double distancePos, pcl::visualization::PCLVisualizer::Ptr& v
 	double poleWidth = 0.5;
 	double poleHeight = 3;
 
+	std::vector<Box> poles;
 	//double distancePos = 7;
 	double markerPos = (roadLengthBehind/poleSpace)*poleSpace-distancePos;
 	while(markerPos < roadLengthBehind)
 		markerPos+=poleSpace;
-	int poleIndex = 0;
 	while(markerPos <= roadLengthAhead) 
 	{
 		//	left pole
-		viewer->addCube(-poleWidth/2+markerPos, poleWidth/2+markerPos, -poleWidth/2+roadWidth/2+poleCurve, poleWidth/2+roadWidth/2+poleCurve, 0, poleHeight, 1, 0.5, 0, "pole_"+std::to_string(poleIndex)+"l");
-		viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_REPRESENTATION, pcl::visualization::PCL_VISUALIZER_REPRESENTATION_SURFACE, "pole_"+std::to_string(poleIndex)+"l");
-		viewer->addCube(-poleWidth/2+markerPos, poleWidth/2+markerPos, -poleWidth/2+roadWidth/2+poleCurve, poleWidth/2+roadWidth/2+poleCurve, 0, poleHeight, 0, 0, 0, "pole_"+std::to_string(poleIndex)+"lframe");
-		viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_REPRESENTATION, pcl::visualization::PCL_VISUALIZER_REPRESENTATION_WIREFRAME, "pole_"+std::to_string(poleIndex)+"lframe");
+		Box l = {float(-poleWidth/2+markerPos), float(-poleWidth/2+roadWidth/2+poleCurve), 0,
+			float(poleWidth/2+markerPos), float(poleWidth/2+roadWidth/2+poleCurve), float(poleHeight)};
+		poles.push_back(l);
 
 		//	right pole
-		viewer->addCube(-poleWidth/2+markerPos, poleWidth/2+markerPos, -poleWidth/2-roadWidth/2-poleCurve, poleWidth/2-roadWidth/2-poleCurve, 0, poleHeight, 1, 0.5, 0, "pole_"+std::to_string(poleIndex)+"r");
-		viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_REPRESENTATION, pcl::visualization::PCL_VISUALIZER_REPRESENTATION_SURFACE, "pole_"+std::to_string(poleIndex)+"r");
-		viewer->addCube(-poleWidth/2+markerPos, poleWidth/2+markerPos, -poleWidth/2-roadWidth/2-poleCurve, poleWidth/2-roadWidth/2-poleCurve, 0, poleHeight, 0, 0, 0, "pole_"+std::to_string(poleIndex)+"rframe");
-		viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_REPRESENTATION, pcl::visualization::PCL_VISUALIZER_REPRESENTATION_WIREFRAME, "pole_"+std::to_string(poleIndex)+"rframe");
+		Box r = {float(-poleWidth/2+markerPos), float(-poleWidth/2-roadWidth/2-poleCurve), 0,
+			float(poleWidth/2+markerPos), float(poleWidth/2-roadWidth/2-poleCurve), float(poleHeight)};
+		poles.push_back(r);
 
 		markerPos+=poleSpace;
-		poleIndex++;
 	}
-
+	return poles;
 }
 
 int countRays = 0;
@@ -189,6 +189,8 @@ struct Car
 };
 
 void renderHighway(double distancePos, pcl::visualization::PCLVisualizer::Ptr& viewer);
+// boxes of the poles along the highway, left then right pole of each pair
+std::vector<Box> highwayPoles(double distancePos);
 void renderRays(pcl::visualization::PCLVisualizer::Ptr& viewer, const Vect3& origin, const pcl::PointCloud<pcl::PointXYZ>::Ptr& cloud);
 void clearRays(pcl::visualization::PCLVisualizer::Ptr& viewer);
 void renderPointCloud(pcl::visualization::PCLVisualizer::Ptr& viewer, const pcl::PointCloud<pcl::PointXYZ>::Ptr& cloud, std::string name, Color color = Color(1, 1, 1));
@@ -0,0 +1,142 @@
+#ifndef SENSOR_MODELS_H
+#define SENSOR_MODELS_H
+
+#include "Eigen/Dense"
+#include "ctrv_kernel.h"
+#include <cmath>
+
+/**
+ * Measurement models consumed by the generic updates of UKFFixed.
+ *
+ * A model derives from SensorModel<NZ>, which carries the measurement noise
+ * and marks the angular components, and provides one of
+ *  - state_index[NZ]: the state components it measures directly (H is a
+ *    selection), for the closed-form UKFFixed::UpdateLinear, or
+ *  - Measure(Xsig, Zsig): maps predicted sigma points to measurement space,
+ *    for UKFFixed::UpdateUnscented. Both arguments are row-major, one row per
+ *    component, so the mapping can run over all sigma points at once.
+ * A new sensor type is a new model here, not another update routine.
+ */
+namespace sensor {
+
+template <int NZ>
+struct SensorModel {
+  static const int n_z = NZ;
+
+  typedef Eigen::Matrix<double, NZ, 1, Eigen::DontAlign> Vector;
+  typedef Eigen::Matrix<double, NZ, NZ, Eigen::DontAlign> Matrix;
+
+  SensorModel() : noise_std(Vector::Zero()) {
+    for (int i = 0; i < NZ; i++)
+      angular[i] = false;
+  }
+
+  /**
+   * Adds the measurement noise covariance R = diag(noise_std)^2 to S.
+   */
+  template <typename D>
+  void AddNoise(Eigen::MatrixBase<D>& S) const {
+    for (int i = 0; i < NZ; i++)
+      S(i,i) += noise_std(i)*noise_std(i);
+  }
+
+  /**
+   * Wraps the angular rows of a residual (or of every column of a matrix of
+   * residuals) to [-pi, pi].
+   */
+  template <typename D>
+  void NormalizeAngles(Eigen::MatrixBase<D>& z_diff) const {
+    for (int r = 0; r < NZ; r++) {
+      if (!angular[r])
+        continue;
+      for (int c = 0; c < z_diff.cols(); c++) {
+        while (z_diff(r,c)> M_PI) z_diff(r,c)-=2.*M_PI;
+        while (z_diff(r,c)<-M_PI) z_diff(r,c)+=2.*M_PI;
+      }
+    }
+  }
+
+  // measurement noise standard deviations
+  Vector noise_std;
+
+  // true for the components that are angles
+  bool angular[NZ];
+};
+
+/**
+ * Lidar: measures px and py directly.
+ */
+struct LidarModel : public SensorModel<2> {
+  LidarModel(double std_px, double std_py) {
+    noise_std << std_px, std_py;
+    state_index[0] = 0;
+    state_index[1] = 1;
+  }
+
+  // measured state components
+  int state_index[2];
+};
+
+/**
+ * Radar: measures [rho, phi, rho_dot] of a CTRV state, phi is an angle.
+ */
+struct RadarModel : public SensorModel<3> {
+  RadarModel(double std_r, double std_phi, double std_rd) {
+    noise_std << std_r, std_phi, std_rd;
+    angular[1] = true;
+  }
+
+  template <typename XSig, typename ZSig>
+  void Measure(const XSig& Xsig, ZSig& Zsig) const {
+    typedef typename XSig::Scalar Scalar;
+    const Scalar* rows_in[4] = {Xsig.row(0).data(), Xsig.row(1).data(),
+                                Xsig.row(2).data(), Xsig.row(3).data()};
+    Scalar* rows_out[3] = {Zsig.row(0).data(), Zsig.row(1).data(), Zsig.row(2).data()};
+    ctrv::RadarMeasurement(rows_in, rows_out, Xsig.cols());
+  }
+};
+
+/**
+ * Inverse of a small innovation covariance. Eigen's fixed-size inverse is
+ * already closed form up to 4x4; the 2x2 case is spelled out since it is
+ * the lidar hot path.
+ */
+template <typename M>
+inline M Inverse(const M& S) {
+  return S.inverse();
+}
+
+template <typename T>
+inline Eigen::Matrix<T, 2, 2, Eigen::DontAlign> Inverse(const Eigen::Matrix<T, 2, 2, Eigen::DontAlign>& S) {
+  Eigen::Matrix<T, 2, 2, Eigen::DontAlign> Si;
+  const T inv_det = T(1) / (S(0,0)*S(1,1) - S(0,1)*S(1,0));
+  Si(0,0) =  S(1,1) * inv_det;
+  Si(0,1) = -S(0,1) * inv_det;
+  Si(1,0) = -S(1,0) * inv_det;
+  Si(1,1) =  S(0,0) * inv_det;
+  return Si;
+}
+
+/**
+ * Normalized innovation squared z_diff^T * S^-1 * z_diff of a residual, given
+ * the inverse Si the update already has. For a consistent filter it is
+ * chi-square distributed with n_z degrees of freedom.
+ */
+template <typename M, typename V>
+inline double Nis(const M& Si, const V& z_diff) {
+  return double(z_diff.dot(Si * z_diff));
+}
+
+/**
+ * Log of the Gaussian density of a residual, given its covariance S and its
+ * NIS.
+ */
+template <typename M>
+inline double LogLikelihood(const M& S, double nis) {
+  const int n_z = M::RowsAtCompileTime;
+  return -0.5 * (nis + std::log(double(S.determinant())) + n_z * std::log(2.0 * M_PI));
+}
+
+}  // namespace sensor
+
+#endif  // SENSOR_MODELS_H
@@ -1,88 +1,84 @@
 #ifndef LIDAR_H
 #define LIDAR_H
 #include "../render/render.h"
+#include "obstacle_grid.h"
+#include "ray_packet.h"
+#include "../noise.h"
+#include "../thread_pool.h"
 #include <ctime>
 #include <chrono>
+#include <iostream>
 
 const double pi = 3.1415;
 
-struct Ray
+// how a ray finds what it hits: marching in resolution steps and testing
+// each step, solving the intersections with the ground and the car boxes,
+// or solving them for packets of neighbouring rays in SIMD lanes
+enum CastMethod
 {
-	
-	Vect3 origin;
-	double resolution;
-	Vect3 direction;
-	Vect3 castPosition;
-	double castDistance;
+	Marching, Analytic, AnalyticPacket
+};
+
+// unit directions of the lidar rays, one array per component; fixed once
+// the lidar is built and only read while scanning
+struct RayTable
+{
+	std::vector<double> x, y, z;
 
 	// parameters:
-	// setOrigin: the starting position from where the ray is cast
 	// horizontalAngle: the angle of direction the ray travels on the xy plane
-	// verticalAngle: the angle of direction between xy plane and ray 
+	// verticalAngle: the angle of direction between xy plane and ray
 	// 				  for example 0 radians is along xy plane and pi/2 radians is stright up
-	// resoultion: the magnitude of the ray's step, used for ray casting, the smaller the more accurate but the more expensive
-
-	Ray(Vect3 setOrigin, double horizontalAngle, double verticalAngle, double setResolution)
-		: origin(setOrigin), resolution(setResolution), direction(resolution*cos(verticalAngle)*cos(horizontalAngle), resolution*cos(verticalAngle)*sin(horizontalAngle),resolution*sin(verticalAngle)),
-		  castPosition(origin), castDistance(0)
-	{}
-
-	void rayCast(const std::vector<Car>& cars, double minDistance, double maxDistance, pcl::PointCloud<pcl::PointXYZ>::Ptr& cloud, double slopeAngle, double sderr)
+	void add(double horizontalAngle, double verticalAngle)
 	{
-		// reset ray
-		castPosition = origin;
-		castDistance = 0;
-
-		bool collision = false;
-
-		while(!collision && castDistance < maxDistance && (castPosition.y <= 6 && castPosition.y >= -6 && castPosition.x <= 50 && castPosition.x >= -15))
-		{
-
-			castPosition = castPosition + direction;
-			castDistance += resolution;
-
-			// check if there is any collisions with ground slope
-			collision = (castPosition.z <= castPosition.x * tan(slopeAngle));
-
-			// check if there is any collisions with cars
-			if(!collision && castDistance < maxDistance)
-			{
-				for(Car car : cars)
-				{
-					collision |= car.checkCollision(castPosition);
-					if(collision)
-						break;
-				}
-			}
-		}
-
-		if((castDistance >= minDistance)&&(castDistance<=maxDistance)&& (castPosition.y <= 6 && castPosition.y >= -6 && castPosition.x <= 50 && castPosition.x >= -15))
-		{
-			// add noise based on standard deviation error
-			double rx = ((double) rand() / (RAND_MAX));
-			double ry = ((double) rand() / (RAND_MAX));
-			double rz = ((double) rand() / (RAND_MAX));
-			cloud->points.push_back(pcl::PointXYZ(castPosition.x+rx*sderr, castPosition.y+ry*sderr, castPosition.z+rz*sderr));
-		}
-			
+		x.push_back(cos(verticalAngle)*cos(horizontalAngle));
+		y.push_back(cos(verticalAngle)*sin(horizontalAngle));
+		z.push_back(sin(verticalAngle));
 	}
 
+	int size() const
+	{
+		return x.size();
+	}
 };
 
 struct Lidar
 {
 
-	std::vector<Ray> rays;
+	RayTable rays;
 	pcl::PointCloud<pcl::PointXYZ>::Ptr cloud;
-	std::vector<Car> cars;
+	// boxes of everything the lidar sees, cars first then poles, the grid
+	// over them and their sectors seen from position; rebuilt by updateCars,
+	// updatePoles and updateObstacles, which must follow a change of position
+	ObstacleTable obstacles;
+	ObstacleGrid grid;
+	SectorTable sectors;
+	std::vector<OrientedBox> carBoxes;
+	std::vector<Box> poles;
 	Vect3 position;
 	double groundSlope;
 	double minDistance;
 	double maxDistance;
+	// resoultion: the magnitude of the ray's step when marching, the smaller the more accurate but the more expensive
 	double resoultion;
 	double sderr;
+	// part of the scene points are kept from, the road by default; set
+	// roadHalfWidth to 11 to see the poles
+	double roadMinX;
+	double roadMaxX;
+	double roadHalfWidth;
+	CastMethod castMethod;
+	// key of the point noise, drawn per ray and scan so a scan is the same
+	// on any number of threads
+	uint64_t noiseSeed;
+	long long scanCount;
+	// points of each block of rays, merged in ray order after a scan
+	std::vector<pcl::PointCloud<pcl::PointXYZ>::VectorType> blockPoints;
+
+	// rays per block, the unit of work of a parallel scan
+	static const int blockSize = 4096;
 
-	Lidar(std::vector<Car> setCars, double setGroundSlope)
+	Lidar(const std::vector<Car>& setCars, double setGroundSlope)
 		: cloud(new pcl::PointCloud<pcl::PointXYZ>()), position(0,0,3.0)
 	{
 		// TODO:: set minDistance to 5 to remove points from roof of ego car
@@ -91,7 +87,16 @@ struct Lidar
 		resoultion = 0.2;
 		// TODO:: set sderr to 0.2 to get more interesting pcd files
 		sderr = 0.02;
-		cars = setCars;
+		roadMinX = -15;
+		roadMaxX = 50;
+		roadHalfWidth = 6;
+		// marching is kept as the reference to compare against, and Analytic
+		// casts one ray at a time with the same results as AnalyticPacket
+		castMethod = AnalyticPacket;
+		noiseSeed = 0;
+		scanCount = 0;
+		poles = highwayPoles(0);
+		updateCars(setCars);
 		groundSlope = setGroundSlope;
 
 		// TODO:: increase number of layers to 8 to get higher resoultion pcd
@@ -107,10 +112,7 @@ struct Lidar
 		for(double angleVertical = steepestAngle; angleVertical < steepestAngle+angleRange; angleVertical+=angleIncrement)
 		{
 			for(double angle = 0; angle <= 2*pi; angle+=horizontalAngleInc)
-			{
-				Ray ray(position,angle,angleVertical,resoultion);
-				rays.push_back(ray);
-			}
+				rays.add(angle, angleVertical);
 		}
 	}
 
@@ -119,21 +121,206 @@ struct Lidar
 		// pcl uses boost smart pointers for cloud pointer so we don't have to worry about manually freeing the memory
 	}
 
-	void updateCars(std::vector<Car> setCars)
+	// takes the body and cabin boxes of the cars, nothing else of the cars
+	// is kept
+	void updateCars(const std::vector<Car>& setCars)
+	{
+		takeCars(setCars);
+		updateObstacles();
+	}
+
+	// moves the poles to where renderHighway draws them at distancePos
+	void updatePoles(double distancePos)
+	{
+		poles = highwayPoles(distancePos);
+		updateObstacles();
+	}
+
+	// updateCars and updatePoles for a new frame, rebuilding once
+	void updateScene(const std::vector<Car>& setCars, double distancePos)
+	{
+		takeCars(setCars);
+		poles = highwayPoles(distancePos);
+		updateObstacles();
+	}
+
+	void takeCars(const std::vector<Car>& setCars)
+	{
+		carBoxes.clear();
+		for(const Car& car : setCars)
+		{
+			carBoxes.push_back(carBody(car));
+			carBoxes.push_back(carCabin(car));
+		}
+	}
+
+	// packs the car boxes and poles and rebuilds the grid and sectors
+	void updateObstacles()
+	{
+		obstacles.clear();
+		for(const OrientedBox& box : carBoxes)
+			obstacles.add(box);
+		obstacles.addBoxes(poles);
+		grid.build(obstacles);
+		sectors.build(obstacles, position);
+	}
+
+	// whether a point is in the kept part of the scene
+	bool onRoad(const Vect3& p) const
 	{
-		cars = setCars;
+		return p.y <= roadHalfWidth && p.y >= -roadHalfWidth && p.x <= roadMaxX && p.x >= roadMinX;
 	}
 
-	pcl::PointCloud<pcl::PointXYZ>::Ptr scan()
+	// whether a hit at distance from the lidar is in range and on the road
+	bool inRange(const Vect3& hit, double distance) const
 	{
- 
+		return (distance >= minDistance)&&(distance<=maxDistance)&& onRoad(hit);
+	}
+
+	// marches ray i in resoultion steps until it hits the ground or an
+	// obstacle, returns true if the hit is in range and on the road
+	bool castMarching(int i, Vect3& hit) const
+	{
+		double stepX = resoultion*rays.x[i];
+		double stepY = resoultion*rays.y[i];
+		double stepZ = resoultion*rays.z[i];
+		hit = position;
+		double castDistance = 0;
+
+		bool collision = false;
+
+		while(!collision && castDistance < maxDistance && onRoad(hit))
+		{
+
+			hit = Vect3(hit.x + stepX, hit.y + stepY, hit.z + stepZ);
+			castDistance += resoultion;
+
+			// check if there is any collisions with ground slope
+			collision = (hit.z <= hit.x * tan(groundSlope));
+
+			// check if there is any collisions with cars
+			if(!collision && castDistance < maxDistance)
+			{
+				for(int j = 0; j < obstacles.size() && !collision; j++)
+					collision = obstacles.contains(j, hit);
+			}
+		}
+
+		return inRange(hit, castDistance);
+	}
+
+	// same as castMarching, but finds the exact hit in closed form, testing
+	// only the obstacles in the grid cells along the ray
+	bool castAnalytic(int i, Vect3& hit) const
+	{
+		Vect3 dir(rays.x[i], rays.y[i], rays.z[i]);
+		double t;
+		if(!rayIntersect(position, dir, obstacles, grid, groundSlope, t) || t > maxDistance)
+			return false;
+
+		hit = Vect3(position.x + t*dir.x, position.y + t*dir.y, position.z + t*dir.z);
+		return inRange(hit, t);
+	}
+
+	// casts the simd_math::Pack::kWidth rays from i on as one packet against
+	// the boxes of their sector, writing their distances to t, infinity
+	// where nothing is hit; false if the rays are not all in one sector
+	bool castPacket(int i, double* t) const
+	{
+		typedef simd_math::Pack Packet;
+		int last = i + Packet::kWidth - 1;
+		// the azimuths grow along a layer, so the ends share a sector only if
+		// every ray does
+		int sector = sectors.sector(rays.x[i], rays.y[i]);
+		if(sector != sectors.sector(rays.x[last], rays.y[last]))
+			return false;
+
+		int begin = sectors.sectorStart[sector];
+		rayPacketIntersect<Packet>(position, &rays.x[i], &rays.y[i], &rays.z[i], obstacles, sectors.items.data() + begin,
+			sectors.distance.data() + begin, sectors.sectorStart[sector+1] - begin, groundSlope, t);
+		return true;
+	}
+
+	// adds the hit of ray i to points, with noise based on standard deviation
+	// error from a counter based stream keyed by the ray and the scan
+	void addPoint(int i, const Vect3& hit, pcl::PointCloud<pcl::PointXYZ>::VectorType& points) const
+	{
+		uint32_t counter[4] = {(uint32_t)i, (uint32_t)scanCount, (uint32_t)(scanCount >> 32), 0};
+		uint32_t key[2] = {(uint32_t)noiseSeed, (uint32_t)(noiseSeed >> 32)};
+		uint32_t bits[4];
+		rng::Philox4x32(counter, key, bits);
+		double rx = bits[0] * (1.0 / 4294967296.0);
+		double ry = bits[1] * (1.0 / 4294967296.0);
+		double rz = bits[2] * (1.0 / 4294967296.0);
+		points.push_back(pcl::PointXYZ(hit.x+rx*sderr, hit.y+ry*sderr, hit.z+rz*sderr));
+	}
+
+	// casts the rays of block b into blockPoints[b]; with AnalyticPacket the
+	// packets that span two sectors and the rays after the last whole packet
+	// are cast one at a time
+	void scanBlock(int b)
+	{
+		typedef simd_math::Pack Packet;
+		pcl::PointCloud<pcl::PointXYZ>::VectorType& points = blockPoints[b];
+		points.clear();
+		int end = std::min(rays.size(), (b+1)*blockSize);
+		int i = b*blockSize;
+		if(castMethod == AnalyticPacket)
+		{
+			double t[Packet::kWidth];
+			for(; i + Packet::kWidth <= end; i += Packet::kWidth)
+			{
+				bool packet = castPacket(i, t);
+				for(int lane = 0; lane < Packet::kWidth; lane++)
+				{
+					int ray = i + lane;
+					Vect3 hit(0, 0, 0);
+					bool kept;
+					if(packet)
+					{
+						hit = Vect3(position.x + t[lane]*rays.x[ray], position.y + t[lane]*rays.y[ray], position.z + t[lane]*rays.z[ray]);
+						kept = t[lane] <= maxDistance && inRange(hit, t[lane]);
+					}
+					else
+						kept = castAnalytic(ray, hit);
+					if(kept)
+						addPoint(ray, hit, points);
+				}
+			}
+		}
+		for(; i < end; i++)
+		{
+			Vect3 hit(0, 0, 0);
+			bool inRange = castMethod == Marching ? castMarching(i, hit) : castAnalytic(i, hit);
+			if(inRange)
+				addPoint(i, hit, points);
+		}
+	}
+
+	// casts every ray, on the threads of pool if given; the cloud is the
+	// same for any number of threads
+	pcl::PointCloud<pcl::PointXYZ>::Ptr scan(ThreadPool* pool = NULL)
+	{
+
 		cloud->points.clear();
 		auto startTime = std::chrono::steady_clock::now();
-		for(Ray ray : rays)
-			ray.rayCast(cars, minDistance, maxDistance, cloud, groundSlope, sderr);
+		int numBlocks = (rays.size() + blockSize - 1) / blockSize;
+		blockPoints.resize(numBlocks);
+		auto scanBlocks = [this](int begin, int end)
+		{
+			for(int b = begin; b < end; b++)
+				scanBlock(b);
+		};
+		if(pool)
+			pool->ParallelFor(numBlocks, scanBlocks);
+		else
+			scanBlocks(0, numBlocks);
+		for(int b = 0; b < numBlocks; b++)
+			cloud->points.insert(cloud->points.end(), blockPoints[b].begin(), blockPoints[b].end());
+		scanCount++;
 		auto endTime = std::chrono::steady_clock::now();
 		auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-		cout << "ray casting took " << elapsedTime.count() << " milliseconds" << endl;
+		std::cout << "ray casting took " << elapsedTime.count() << " milliseconds" << std::endl;
 		cloud->width = cloud->points.size();
 		cloud->height = 1; // one dimensional unorganized point cloud dataset
 		return cloud;
@@ -141,4 +328,4 @@ struct Lidar
 
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,174 @@
+#ifndef OBSTACLE_GRID_H
+#define OBSTACLE_GRID_H
+#include "ray_intersect.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Uniform 2D grid over the xy footprints of an ObstacleTable. Each cell
+// lists the boxes whose footprint overlaps it, and a ray walks the cells its
+// xy projection crosses in order (Amanatides and Woo), testing only the
+// boxes listed there and stopping at the first cell that holds a hit. Cost
+// per ray follows the cells crossed and the boxes near the ray instead of
+// the number of boxes in the scene. The grid is rebuilt from scratch, which
+// is a counting sort over the boxes.
+struct ObstacleGrid
+{
+	// edge of a square cell in meters
+	double cellSize;
+	double minX, minY;
+	int cellsX, cellsY;
+	// boxes overlapping cell c are items[cellStart[c]] .. items[cellStart[c+1]-1]
+	std::vector<int> cellStart;
+	std::vector<int> items;
+
+	ObstacleGrid()
+		: cellSize(4), minX(0), minY(0), cellsX(0), cellsY(0)
+	{}
+
+	void build(const ObstacleTable& boxes)
+	{
+		int n = boxes.size();
+		cellsX = cellsY = 0;
+		cellStart.assign(1, 0);
+		items.clear();
+		if(n == 0)
+			return;
+
+		// world xy bounds of every box footprint
+		std::vector<double> lowX(n), lowY(n), highX(n), highY(n);
+		for(int i = 0; i < n; i++)
+		{
+			double c = std::fabs(boxes.cosNegTheta[i]);
+			double s = std::fabs(boxes.sinNegTheta[i]);
+			double extentX = c * boxes.halfX[i] + s * boxes.halfY[i];
+			double extentY = s * boxes.halfX[i] + c * boxes.halfY[i];
+			lowX[i] = boxes.centerX[i] - extentX;
+			highX[i] = boxes.centerX[i] + extentX;
+			lowY[i] = boxes.centerY[i] - extentY;
+			highY[i] = boxes.centerY[i] + extentY;
+		}
+		minX = *std::min_element(lowX.begin(), lowX.end());
+		minY = *std::min_element(lowY.begin(), lowY.end());
+		double maxX = *std::max_element(highX.begin(), highX.end());
+		double maxY = *std::max_element(highY.begin(), highY.end());
+		cellsX = std::max(1, (int)std::ceil((maxX - minX) / cellSize));
+		cellsY = std::max(1, (int)std::ceil((maxY - minY) / cellSize));
+
+		// count the boxes of each cell, prefix sum, then place them
+		cellStart.assign(cellsX * cellsY + 1, 0);
+		for(int pass = 0; pass < 2; pass++)
+		{
+			std::vector<int> fill;
+			if(pass == 1)
+			{
+				for(int c = 0; c < cellsX * cellsY; c++)
+					cellStart[c+1] += cellStart[c];
+				items.resize(cellStart.back());
+				fill.assign(cellStart.begin(), cellStart.end() - 1);
+			}
+			for(int i = 0; i < n; i++)
+			{
+				int x0 = cellX(lowX[i]), x1 = cellX(highX[i]);
+				int y0 = cellY(lowY[i]), y1 = cellY(highY[i]);
+				for(int y = y0; y <= y1; y++)
+					for(int x = x0; x <= x1; x++)
+					{
+						if(pass == 0)
+							cellStart[y * cellsX + x + 1]++;
+						else
+							items[fill[y * cellsX + x]++] = i;
+					}
+			}
+		}
+	}
+
+	int cellX(double x) const
+	{
+		return std::min(cellsX - 1, std::max(0, (int)std::floor((x - minX) / cellSize)));
+	}
+
+	int cellY(double y) const
+	{
+		return std::min(cellsY - 1, std::max(0, (int)std::floor((y - minY) / cellSize)));
+	}
+
+	// nearest box hit closer than tMax, walking the cells along the ray
+	bool intersect(const Vect3& origin, const Vect3& dir, const ObstacleTable& boxes, double tMax, double& t) const
+	{
+		if(cellsX == 0)
+			return false;
+
+		// part of the ray over the grid
+		double tNear = 0;
+		double tFar = tMax;
+		double halfX = 0.5 * cellsX * cellSize;
+		double halfY = 0.5 * cellsY * cellSize;
+		if(!clipSlab(origin.x - (minX + halfX), dir.x, halfX, tNear, tFar) ||
+		   !clipSlab(origin.y - (minY + halfY), dir.y, halfY, tNear, tFar))
+			return false;
+
+		int x = cellX(origin.x + tNear * dir.x);
+		int y = cellY(origin.y + tNear * dir.y);
+		int stepX = dir.x > 0 ? 1 : -1;
+		int stepY = dir.y > 0 ? 1 : -1;
+		double inf = std::numeric_limits<double>::infinity();
+		double deltaX = dir.x != 0 ? cellSize / std::fabs(dir.x) : inf;
+		double deltaY = dir.y != 0 ? cellSize / std::fabs(dir.y) : inf;
+		double nextX = dir.x != 0 ? (minX + (x + (dir.x > 0)) * cellSize - origin.x) / dir.x : inf;
+		double nextY = dir.y != 0 ? (minY + (y + (dir.y > 0)) * cellSize - origin.y) / dir.y : inf;
+
+		bool hit = false;
+		t = tMax;
+		while(true)
+		{
+			int c = y * cellsX + x;
+			for(int k = cellStart[c]; k < cellStart[c+1]; k++)
+			{
+				double tBox;
+				if(rayBoxIntersect(origin, dir, boxes, items[k], tBox) && tBox < t)
+				{
+					t = tBox;
+					hit = true;
+				}
+			}
+
+			// a hit before the ray leaves this cell cannot be beaten by
+			// boxes further along
+			double tExit = std::min(std::min(nextX, nextY), tFar);
+			if((hit && t <= tExit) || tExit >= tFar)
+				return hit;
+
+			if(nextX < nextY)
+			{
+				x += stepX;
+				nextX += deltaX;
+				if(x < 0 || x >= cellsX)
+					return hit;
+			}
+			else
+			{
+				y += stepY;
+				nextY += deltaY;
+				if(y < 0 || y >= cellsY)
+					return hit;
+			}
+		}
+	}
+};
+
+// nearest hit of the ray on the ground or any obstacle of the grid, false if
+// nothing is hit
+inline bool rayIntersect(const Vect3& origin, const Vect3& dir, const ObstacleTable& boxes, const ObstacleGrid& grid, double slopeAngle, double& t)
+{
+	double tGround;
+	bool ground = rayGroundIntersect(origin, dir, slopeAngle, tGround);
+	double tMax = ground ? tGround : std::numeric_limits<double>::infinity();
+	if(grid.intersect(origin, dir, boxes, tMax, t))
+		return true;
+	t = tGround;
+	return ground;
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef RAY_INTERSECT_H
+#define RAY_INTERSECT_H
+#include "../render/render.h"
+#include <cmath>
+#include <limits>
+
+// Closed form ray intersections for the lidar simulator. Rays are given by
+// an origin and a unit direction, so the returned t is the distance from the
+// origin to the hit.
+
+// box rotated about the z axis, the shape Car::checkCollision tests against
+struct OrientedBox
+{
+	Vect3 center;
+	// half of the size along the box's own x, y and z axes
+	Vect3 halfSize;
+	// rotation from world to box axes
+	double cosNegTheta;
+	double sinNegTheta;
+
+	OrientedBox(Vect3 setCenter, Vect3 setHalfSize, double setCosNegTheta, double setSinNegTheta)
+		: center(setCenter), halfSize(setHalfSize), cosNegTheta(setCosNegTheta), sinNegTheta(setSinNegTheta)
+	{}
+};
+
+// the two stacked boxes of a car: body over the full footprint and the
+// cabin over the middle half of its length
+inline OrientedBox carBody(const Car& car)
+{
+	return OrientedBox(Vect3(car.position.x, car.position.y, car.position.z + car.dimensions.z / 3),
+		Vect3(car.dimensions.x / 2, car.dimensions.y / 2, car.dimensions.z / 3), car.cosNegTheta, car.sinNegTheta);
+}
+
+inline OrientedBox carCabin(const Car& car)
+{
+	return OrientedBox(Vect3(car.position.x, car.position.y, car.position.z + car.dimensions.z * 5 / 6),
+		Vect3(car.dimensions.x / 4, car.dimensions.y / 2, car.dimensions.z / 6), car.cosNegTheta, car.sinNegTheta);
+}
+
+// a box that is not rotated, such as a pole
+inline OrientedBox axisAlignedBox(const Box& box)
+{
+	return OrientedBox(Vect3((box.x_min + box.x_max) / 2, (box.y_min + box.y_max) / 2, (box.z_min + box.z_max) / 2),
+		Vect3((box.x_max - box.x_min) / 2, (box.y_max - box.y_min) / 2, (box.z_max - box.z_min) / 2), 1, 0);
+}
+
+// narrows [tNear, tFar] to where the ray is inside the slab |o + t*d| <= h,
+// returns false once the interval is empty
+inline bool clipSlab(double o, double d, double h, double& tNear, double& tFar)
+{
+	if(d == 0)
+		return o >= -h && o <= h;
+	double t1 = (-h - o) / d;
+	double t2 = (h - o) / d;
+	if(t1 > t2)
+		std::swap(t1, t2);
+	tNear = std::max(tNear, t1);
+	tFar = std::min(tFar, t2);
+	return tNear <= tFar;
+}
+
+// every obstacle box of the scene packed one array per field, so a ray
+// query streams through plain doubles instead of touching the cars
+struct ObstacleTable
+{
+	std::vector<double> centerX, centerY, centerZ;
+	std::vector<double> halfX, halfY, halfZ;
+	std::vector<double> cosNegTheta, sinNegTheta;
+
+	int size() const
+	{
+		return centerX.size();
+	}
+
+	void clear()
+	{
+		centerX.clear(); centerY.clear(); centerZ.clear();
+		halfX.clear(); halfY.clear(); halfZ.clear();
+		cosNegTheta.clear(); sinNegTheta.clear();
+	}
+
+	void add(const OrientedBox& box)
+	{
+		centerX.push_back(box.center.x);
+		centerY.push_back(box.center.y);
+		centerZ.push_back(box.center.z);
+		halfX.push_back(box.halfSize.x);
+		halfY.push_back(box.halfSize.y);
+		halfZ.push_back(box.halfSize.z);
+		cosNegTheta.push_back(box.cosNegTheta);
+		sinNegTheta.push_back(box.sinNegTheta);
+	}
+
+	void addBoxes(const std::vector<Box>& boxes)
+	{
+		for(const Box& box : boxes)
+			add(axisAlignedBox(box));
+	}
+
+	// whether point p is inside or on box i
+	bool contains(int i, const Vect3& p) const
+	{
+		double ox = p.x - centerX[i];
+		double oy = p.y - centerY[i];
+		double lx = ox * cosNegTheta[i] - oy * sinNegTheta[i];
+		double ly = oy * cosNegTheta[i] + ox * sinNegTheta[i];
+		return std::fabs(lx) <= halfX[i] && std::fabs(ly) <= halfY[i] && std::fabs(p.z - centerZ[i]) <= halfZ[i];
+	}
+};
+
+// distance to where the ray enters box i, 0 if it starts inside
+inline bool rayBoxIntersect(const Vect3& origin, const Vect3& dir, const ObstacleTable& boxes, int i, double& t)
+{
+	// ray in box axes
+	double ox = origin.x - boxes.centerX[i];
+	double oy = origin.y - boxes.centerY[i];
+	double c = boxes.cosNegTheta[i];
+	double s = boxes.sinNegTheta[i];
+	double lox = ox * c - oy * s;
+	double loy = oy * c + ox * s;
+	double loz = origin.z - boxes.centerZ[i];
+	double ldx = dir.x * c - dir.y * s;
+	double ldy = dir.y * c + dir.x * s;
+	double ldz = dir.z;
+
+	double tNear = 0;
+	double tFar = std::numeric_limits<double>::infinity();
+	if(clipSlab(lox, ldx, boxes.halfX[i], tNear, tFar) &&
+	   clipSlab(loy, ldy, boxes.halfY[i], tNear, tFar) &&
+	   clipSlab(loz, ldz, boxes.halfZ[i], tNear, tFar))
+	{
+		t = tNear;
+		return true;
+	}
+	return false;
+}
+
+// distance to the ground plane z = x*tan(slopeAngle), for rays going down
+// relative to it
+inline bool rayGroundIntersect(const Vect3& origin, const Vect3& dir, double slopeAngle, double& t)
+{
+	double k = tan(slopeAngle);
+	double denom = dir.z - dir.x * k;
+	if(denom >= 0)
+		return false;
+	t = std::max(0.0, (origin.x * k - origin.z) / denom);
+	return true;
+}
+
+// nearest hit of the ray on the ground or any obstacle, false if nothing is
+// hit
+inline bool rayIntersect(const Vect3& origin, const Vect3& dir, const ObstacleTable& boxes, double slopeAngle, double& t)
+{
+	bool hit = rayGroundIntersect(origin, dir, slopeAngle, t);
+	if(!hit)
+		t = std::numeric_limits<double>::infinity();
+	for(int i = 0; i < boxes.size(); i++)
+	{
+		double tBox;
+		if(rayBoxIntersect(origin, dir, boxes, i, tBox) && tBox < t)
+		{
+			t = tBox;
+			hit = true;
+		}
+	}
+	return hit;
+}
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef RAY_PACKET_H
+#define RAY_PACKET_H
+#include "ray_intersect.h"
+#include "../simd_math.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Ray packets for the lidar simulator: V::kWidth rays from one origin, cast
+// against the ground and a list of boxes one box at a time for all lanes. Each
+// lane runs the arithmetic of rayGroundIntersect and rayBoxIntersect with the
+// branches turned into simd_math Min/Max/Select, so its distance is
+// bit-identical to the scalar one. V is a simd_math double pack, Scalar being
+// the fallback.
+
+// Obstacles by the azimuth sectors they cover seen from one origin, nearest
+// first in each sector, with the distance from the origin to each box. A ray
+// from that origin only has to test the sector of its direction, in order,
+// and can stop at the first box farther than its hit. Like ObstacleGrid the
+// table is rebuilt from scratch whenever the boxes or the origin move.
+struct SectorTable
+{
+	int numSectors;
+	// boxes of sector s are items[sectorStart[s]] .. items[sectorStart[s+1]-1],
+	// at least distance[k] away from the origin
+	std::vector<int> sectorStart;
+	std::vector<int> items;
+	std::vector<double> distance;
+
+	SectorTable()
+		: numSectors(128)
+	{}
+
+	// sector of the direction (x, y)
+	int sector(double x, double y) const
+	{
+		int s = (int)std::floor((atan2(y, x) + M_PI) * (numSectors / (2 * M_PI)));
+		return std::min(numSectors - 1, std::max(0, s));
+	}
+
+	void build(const ObstacleTable& boxes, const Vect3& origin)
+	{
+		int n = boxes.size();
+		// first and last sector of every box, in nearest first order
+		std::vector<std::pair<double, int> > order(n);
+		std::vector<int> first(n), last(n);
+		for(int i = 0; i < n; i++)
+		{
+			double c = boxes.cosNegTheta[i];
+			double s = boxes.sinNegTheta[i];
+			double ox = origin.x - boxes.centerX[i];
+			double oy = origin.y - boxes.centerY[i];
+			double lox = ox * c - oy * s;
+			double loy = oy * c + ox * s;
+			double loz = origin.z - boxes.centerZ[i];
+
+			// distance from the origin to the box, less a margin for rounding
+			double dx = std::max(std::fabs(lox) - boxes.halfX[i], 0.0);
+			double dy = std::max(std::fabs(loy) - boxes.halfY[i], 0.0);
+			double dz = std::max(std::fabs(loz) - boxes.halfZ[i], 0.0);
+			order[i] = std::make_pair(sqrt(dx*dx + dy*dy + dz*dz) - 1e-6, i);
+
+			// a box around the origin's vertical is in every sector
+			if(dx == 0 && dy == 0)
+			{
+				first[i] = 0;
+				last[i] = numSectors - 1;
+				continue;
+			}
+
+			// azimuths of the footprint corners relative to the first one; the
+			// footprint is convex and away from the origin, so they span less
+			// than pi
+			double base = 0, low = 0, high = 0;
+			for(int corner = 0; corner < 4; corner++)
+			{
+				double lx = (corner & 1 ? 1 : -1) * boxes.halfX[i];
+				double ly = (corner & 2 ? 1 : -1) * boxes.halfY[i];
+				double angle = atan2(boxes.centerY[i] + ly * c - lx * s - origin.y, boxes.centerX[i] + lx * c + ly * s - origin.x);
+				if(corner == 0)
+					base = angle;
+				double relative = remainder(angle - base, 2 * M_PI);
+				low = std::min(low, relative);
+				high = std::max(high, relative);
+			}
+			double width = 2 * M_PI / numSectors;
+			first[i] = (int)std::floor((base + low - 1e-9 + M_PI) / width);
+			last[i] = (int)std::floor((base + high + 1e-9 + M_PI) / width);
+			if(last[i] - first[i] >= numSectors - 1)
+			{
+				first[i] = 0;
+				last[i] = numSectors - 1;
+			}
+		}
+		std::sort(order.begin(), order.end());
+
+		// count the boxes of each sector, prefix sum, then place them nearest
+		// first
+		sectorStart.assign(numSectors + 1, 0);
+		for(int pass = 0; pass < 2; pass++)
+		{
+			std::vector<int> fill;
+			if(pass == 1)
+			{
+				for(int k = 0; k < numSectors; k++)
+					sectorStart[k+1] += sectorStart[k];
+				items.resize(sectorStart.back());
+				distance.resize(sectorStart.back());
+				fill.assign(sectorStart.begin(), sectorStart.end() - 1);
+			}
+			for(const std::pair<double, int>& box : order)
+			{
+				int i = box.second;
+				for(int k = first[i]; k <= last[i]; k++)
+				{
+					// the sectors of a box may wrap around from the last to the first
+					int sector = (k % numSectors + numSectors) % numSectors;
+					if(pass == 0)
+						sectorStart[sector + 1]++;
+					else
+					{
+						items[fill[sector]] = i;
+						distance[fill[sector]++] = box.first;
+					}
+				}
+			}
+		}
+	}
+};
+
+// narrows [tNear, tFar] of every lane to the slab |o + t*d| <= h; a lane
+// with d = 0 gets infinite bounds, or NaN on the face which Max/Min drop
+template <class V>
+inline void clipSlabPacket(double o, V d, double h, V& tNear, V& tFar)
+{
+	V t1 = V(-h - o) / d;
+	V t2 = V(h - o) / d;
+	tNear = simd_math::Max(simd_math::Min(t1, t2), tNear);
+	tFar = simd_math::Min(simd_math::Max(t1, t2), tFar);
+}
+
+// distances of the lanes to the nearest hit, infinity for a lane that hits
+// nothing. The candidates must be sorted by their lower bound distance, the
+// packet stops at the first candidate no lane can reach before its hit.
+// parameters:
+// dirX, dirY, dirZ: unit directions of the lanes
+// candidates: boxes to test, numCandidates of them
+// candidateDistance: lower bound of the distance to each candidate
+// t: V::kWidth distances
+template <class V>
+inline void rayPacketIntersect(const Vect3& origin, const double* dirX, const double* dirY, const double* dirZ,
+	const ObstacleTable& boxes, const int* candidates, const double* candidateDistance, int numCandidates,
+	double slopeAngle, double* t)
+{
+	const int width = V::kWidth;
+	const V inf(std::numeric_limits<double>::infinity());
+	V dx = V::Load(dirX);
+	V dy = V::Load(dirY);
+	V dz = V::Load(dirZ);
+
+	// ground plane z = x*tan(slopeAngle), for lanes going down relative to it
+	V k(tan(slopeAngle));
+	V denom = dz - dx * k;
+	V tGround = simd_math::Max(V(origin.x * tan(slopeAngle) - origin.z) / denom, V(0.0));
+	V tBest = simd_math::Select(denom < V(0.0), tGround, inf);
+	tBest.Store(t);
+	double farthest = *std::max_element(t, t + width);
+
+	for(int n = 0; n < numCandidates; n++)
+	{
+		// every lane already hit something closer than this box can be
+		if(candidateDistance[n] >= farthest)
+			break;
+
+		int i = candidates[n];
+		double c = boxes.cosNegTheta[i];
+		double s = boxes.sinNegTheta[i];
+
+		// origin in box axes, shared by the lanes
+		double ox = origin.x - boxes.centerX[i];
+		double oy = origin.y - boxes.centerY[i];
+		double lox = ox * c - oy * s;
+		double loy = oy * c + ox * s;
+		double loz = origin.z - boxes.centerZ[i];
+
+		V tNear(0.0);
+		V tFar = inf;
+		clipSlabPacket(lox, dx * V(c) - dy * V(s), boxes.halfX[i], tNear, tFar);
+		clipSlabPacket(loy, dy * V(c) + dx * V(s), boxes.halfY[i], tNear, tFar);
+		clipSlabPacket(loz, dz, boxes.halfZ[i], tNear, tFar);
+
+		// lanes that miss keep their hit
+		V tBox = simd_math::Select(tFar < tNear, inf, tNear);
+		tBest = simd_math::Min(tBox, tBest);
+		tBest.Store(t);
+		farthest = *std::max_element(t, t + width);
+	}
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef SIGMA_POINTS_H
+#define SIGMA_POINTS_H
+
+#include <cmath>
+
+/**
+ * Sigma point sets for UKFFixed. A set of an N-dimensional distribution
+ * provides
+ *  - n_sig: number of points, point 0 is the mean,
+ *  - Weight(i): weight of point i for both the mean and the covariance,
+ *  - Spread(L, X): adds the offsets of the points to X, whose columns all
+ *    hold the mean, given a lower square root L of the covariance.
+ * Spread only moves the first L.cols() dimensions, so a factor of the
+ * leading block spreads those and leaves the rest at the mean.
+ * The rest of the filter only sees n_sig and the weights.
+ */
+namespace sigma {
+
+/**
+ * The symmetric set: the mean and +-sqrt(lambda+N) along every column of L,
+ * 2N+1 points.
+ */
+template <int N>
+struct Symmetric {
+  static const int n_sig = 2 * N + 1;
+
+  // spreading parameter
+  static constexpr double lambda = 3.0 - N;
+
+  static constexpr double Weight(int i) {
+    return i == 0 ? lambda / (lambda + N) : 0.5 / (lambda + N);
+  }
+
+  template <class Factor, class Points>
+  static void Spread(const Factor& L, Points* X) {
+    typedef typename Points::Scalar Scalar;
+    const typename Factor::Scalar scale = std::sqrt(lambda + N);
+    for (int i = 0; i < L.cols(); i++)
+    {
+      X->col(i+1)   += (scale * L.col(i)).template cast<Scalar>();
+      X->col(i+1+N) -= (scale * L.col(i)).template cast<Scalar>();
+    }
+  }
+};
+
+template <int N>
+constexpr double Symmetric<N>::lambda;
+
+/**
+ * The spherical simplex set (Julier 2003): the mean and N+1 points of equal
+ * weight on a sphere, N+2 points. Built one dimension at a time: dimension j
+ * moves points 1..j+1 by -c_j and point j+2 by (j+1)*c_j along column j of L,
+ * with c_j = 1/sqrt((j+1)*(j+2)*W1), so L is applied as a triangle.
+ */
+template <int N>
+struct SphericalSimplex {
+  static const int n_sig = N + 2;
+
+  // weight of the mean, in [0, 1)
+  static constexpr double w0 = 0.25;
+
+  static constexpr double Weight(int i) {
+    return i == 0 ? w0 : (1.0 - w0) / (N + 1);
+  }
+
+  template <class Factor, class Points>
+  static void Spread(const Factor& L, Points* X) {
+    typedef typename Points::Scalar Scalar;
+    typedef typename Factor::Scalar FactorScalar;
+    for (int j = 0; j < L.cols(); j++) {
+      const FactorScalar c = 1.0 / std::sqrt((j + 1) * (j + 2) * Weight(1));
+      for (int i = 1; i <= j + 1; i++)
+        X->col(i) -= (c * L.col(j)).template cast<Scalar>();
+      X->col(j+2) += (FactorScalar(j + 1) * c * L.col(j)).template cast<Scalar>();
+    }
+  }
+};
+
+template <int N>
+constexpr double SphericalSimplex<N>::w0;
+
+}  // namespace sigma
+
+#endif  // SIGMA_POINTS_H
@@ -0,0 +1,89 @@
+#ifndef SQRT_UKF_H
+#define SQRT_UKF_H
+
+#include "Eigen/Dense"
+#include <cmath>
+
+/**
+ * Building blocks of the square-root UKF mode of UKFFixed: the filter keeps
+ * the lower Cholesky factor S of P (P = S*S^T) and updates it with a QR
+ * factorization and rank-1 Cholesky updates/downdates, so P never has to be
+ * refactorized and stays positive definite by construction.
+ */
+
+/**
+ * Rank-1 update (sigma = +1) or downdate (sigma = -1) of a lower Cholesky
+ * factor in place, L*L^T <- L*L^T + sigma*x*x^T. x is used as scratch.
+ * @return false if a downdate would lose positive definiteness; L is then
+ *         partially updated and must be rebuilt by the caller.
+ */
+template <typename MatL, typename VecX>
+bool CholeskyRankUpdate(MatL& L, VecX& x, double sigma) {
+  typedef typename MatL::Scalar Scalar;
+  const int n = L.rows();
+  for (int k = 0; k < n; k++) {
+    Scalar Lkk = L(k,k);
+    Scalar r2 = Lkk*Lkk + Scalar(sigma)*x(k)*x(k);
+    if (!(r2 > 0) || !(Lkk > 0))
+      return false;
+    Scalar r = std::sqrt(r2);
+    Scalar c = r / Lkk;
+    Scalar s = x(k) / Lkk;
+    L(k,k) = r;
+    for (int i = k+1; i < n; i++) {
+      L(i,k) = (L(i,k) + Scalar(sigma)*s*x(i)) / c;
+      x(i) = c*x(i) - s*L(i,k);
+    }
+  }
+  return true;
+}
+
+/**
+ * Computes the lower factor S of sum_i w_i*d_i*d_i^T + diag(noise)^2 for the
+ * NSIG centered sigma points d_i, without forming the sum: the points with
+ * positive weight 1..NSIG-1 and the noise go through one QR factorization,
+ * point 0 is folded in by a rank-1 update or, for a negative weight, downdate.
+ * Storage is fixed-size and owned, so Compute does not allocate.
+ */
+template <int N, int NSIG, typename T = double>
+class SqrtFactorizer {
+ public:
+  typedef Eigen::Matrix<T, NSIG - 1 + N, N, Eigen::DontAlign> Compound;
+  typedef Eigen::Matrix<T, N, N, Eigen::DontAlign> Factor;
+  typedef Eigen::Matrix<T, N, 1, Eigen::DontAlign> Vector;
+
+  /**
+   * @param {Dev} D: N x NSIG centered sigma points
+   * 		  {Weights} w: NSIG sigma point weights, w(1..NSIG-1) > 0
+   * 		  {Noise} noise_sqrt: N standard deviations of additive noise
+   * 		  {Factor*} S: resulting lower factor
+   * @return false if folding in point 0 failed; S is then invalid
+   */
+  template <typename Dev, typename Weights, typename Noise>
+  bool Compute(const Dev& D, const Weights& w, const Noise& noise_sqrt, Factor* S) {
+    for (int i = 1; i < NSIG; i++)
+      compound_.row(i-1) = std::sqrt(w(i)) * D.col(i).transpose();
+    compound_.template bottomRows<N>().setZero();
+    compound_.template bottomRows<N>().diagonal() = noise_sqrt.template cast<T>();
+
+    // S = R^T, with the signs fixed so the diagonal is positive
+    qr_.compute(compound_);
+    S->setZero();
+    S->template triangularView<Eigen::Lower>() =
+        qr_.matrixQR().template topRows<N>().transpose().template triangularView<Eigen::Lower>();
+    for (int j = 0; j < N; j++) {
+      if ((*S)(j,j) < 0)
+        S->col(j) = -S->col(j);
+    }
+
+    point_ = std::sqrt(std::fabs(w(0))) * D.col(0);
+    return CholeskyRankUpdate(*S, point_, w(0) < 0 ? -1.0 : 1.0);
+  }
+
+ private:
+  Compound compound_;
+  Eigen::HouseholderQR<Compound> qr_;
+  Vector point_;
+};
+
+#endif  // SQRT_UKF_H
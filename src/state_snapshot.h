@@ -0,0 +1,96 @@
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include "Eigen/Dense"
+#include <atomic>
+
+/**
+ * State of a track as published for other threads: the time the state is
+ * true, the state and its covariance. A default snapshot is all zeros.
+ */
+template <int NX, typename T = double>
+struct StateSnapshot {
+  typedef Eigen::Matrix<T, NX, 1, Eigen::DontAlign> StateVector;
+  typedef Eigen::Matrix<T, NX, NX, Eigen::DontAlign> StateMatrix;
+
+  StateSnapshot()
+    : timestamp(0), x(StateVector::Zero()), P(StateMatrix::Zero()) {}
+
+  // time when the state is true, in us
+  long long timestamp;
+
+  StateVector x;
+  StateMatrix P;
+};
+
+/**
+ * Single-writer, many-reader publication of a snapshot.
+ *
+ * Two slots and a sequence number: Publish fills the slot the readers are
+ * not on and then bumps the sequence, one atomic store per publish. Read
+ * never blocks the writer; it copies the slot of the sequence it loaded and
+ * retries if the writer published again meanwhile, since the next publish
+ * reuses that slot. Reads and writes of the slots themselves are plain
+ * copies ordered by fences, as in a seqlock.
+ *
+ * Publish must only be called from one thread at a time. Copying a
+ * publisher copies its current snapshot. Read before the first Publish
+ * returns a default-constructed Snapshot.
+ */
+template <class Snapshot>
+class SnapshotPublisher {
+ public:
+  SnapshotPublisher() : sequence_(0) {
+    slots_[0] = Snapshot();
+    slots_[1] = Snapshot();
+  }
+
+  SnapshotPublisher(const SnapshotPublisher& other) : sequence_(0) {
+    other.Read(&slots_[0]);
+  }
+
+  SnapshotPublisher& operator=(const SnapshotPublisher& other) {
+    Snapshot snapshot;
+    other.Read(&snapshot);
+    Publish(snapshot);
+    return *this;
+  }
+
+  /**
+   * Makes snapshot the current one. Writer thread only.
+   */
+  void Publish(const Snapshot& snapshot) {
+    const unsigned long next = sequence_.load(std::memory_order_relaxed) + 1;
+
+    //keeps the slot writes after the previous publish, for the reader check
+    std::atomic_thread_fence(std::memory_order_release);
+    slots_[next & 1] = snapshot;
+    sequence_.store(next, std::memory_order_release);
+  }
+
+  /**
+   * Copies the current snapshot, retrying while the writer overtakes.
+   */
+  void Read(Snapshot* snapshot) const {
+    for (;;) {
+      const unsigned long seq = sequence_.load(std::memory_order_acquire);
+      *snapshot = slots_[seq & 1];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == seq)
+        return;
+    }
+  }
+
+  /**
+   * Number of publishes so far; a reader can poll it for new snapshots.
+   */
+  unsigned long sequence() const {
+    return sequence_.load(std::memory_order_acquire);
+  }
+
+ private:
+  Snapshot slots_[2];
+  std::atomic<unsigned long> sequence_;
+};
+
+#endif  // STATE_SNAPSHOT_H
@@ -0,0 +1,72 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int threads)
+  : body_(NULL), n_(0), generation_(0), pending_(0), stop_(false) {
+  if (threads <= 0)
+    threads = std::thread::hardware_concurrency();
+  for (int i = 1; i < threads; i++)
+    workers_.push_back(std::thread(&ThreadPool::Worker, this, i));
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for (size_t i = 0; i < workers_.size(); i++)
+    workers_[i].join();
+}
+
+void ThreadPool::RunChunk(int i) {
+  const long begin = (long)n_ * i / size();
+  const long end = (long)n_ * (i + 1) / size();
+  if (begin < end)
+    (*body_)(begin, end);
+}
+
+void ThreadPool::ParallelFor(int n, const std::function<void(int, int)>& body) {
+  if (workers_.empty()) {
+    if (n > 0)
+      body(0, n);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    body_ = &body;
+    n_ = n;
+    pending_ = workers_.size();
+    generation_++;
+  }
+  start_.notify_all();
+
+  RunChunk(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return pending_ == 0; });
+  body_ = NULL;
+}
+
+void ThreadPool::Worker(int i) {
+  long seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+      if (stop_)
+        return;
+      seen = generation_;
+    }
+
+    RunChunk(i);
+
+    bool last;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last = --pending_ == 0;
+    }
+    if (last)
+      done_.notify_one();
+  }
+}
@@ -0,0 +1,69 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads for data-parallel loops.
+ *
+ * ParallelFor splits [0, n) into one contiguous chunk per thread, the
+ * calling thread working on chunk 0, and returns when every chunk is done.
+ * The split only depends on n and the thread count, so a loop whose chunks
+ * write disjoint outputs gives the same result on every run. A pool of one
+ * thread runs the loop on the caller.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Constructor
+   * @param {int} threads: threads taking part in a loop, including the
+   * 		  caller; 0 picks std::thread::hardware_concurrency()
+   */
+  explicit ThreadPool(int threads = 0);
+
+  /**
+   * Destructor, joins the workers
+   */
+  ~ThreadPool();
+
+  /**
+   * Number of threads taking part in a loop, including the caller
+   */
+  int size() const { return workers_.size() + 1; }
+
+  /**
+   * Runs body(begin, end) over contiguous chunks of [0, n) in parallel.
+   * @param {int} n: number of items
+   * 		  {function} body: called once per non-empty chunk
+   */
+  void ParallelFor(int n, const std::function<void(int, int)>& body);
+
+ private:
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator=(const ThreadPool&);
+
+  // runs chunk i of the current loop
+  void RunChunk(int i);
+
+  void Worker(int i);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+
+  // current loop, valid while pending_ > 0
+  const std::function<void(int, int)>* body_;
+  int n_;
+
+  // bumped for every loop so each worker runs it once
+  long generation_;
+  int pending_;
+  bool stop_;
+};
+
+#endif  // THREAD_POOL_H
@@ -1,5 +1,4 @@
 #include <iostream>
-#include <random>
 #include "tools.h"
 
 using namespace std;
@@ -9,78 +8,80 @@ Tools::Tools() {}
 
 Tools::~Tools() {}
 
-double Tools::noise(double stddev, long long seedNum)
-{
-	mt19937::result_type seed = seedNum;
-	auto dist = std::bind(std::normal_distribution<double>{0, stddev}, std::mt19937(seed));
-	return dist();
-}
+// noise streams of each sensor at a timestamp
+enum NoiseChannel { kLidarNoise = 0, kRadarNoise = 1 };
 
-// sense where a car is located using lidar measurement
-lmarker Tools::lidarSense(Car& car, pcl::visualization::PCLVisualizer::Ptr& viewer, long long timestamp, bool visualize)
+// sense where a car is located using lidar measurement, the caller feeds
+// meas_package to the car's filter
+lmarker Tools::lidarSense(Car& car, pcl::visualization::PCLVisualizer::Ptr& viewer, long long timestamp, bool visualize, MeasurementPackage& meas_package)
 {
-	MeasurementPackage meas_package;
 	meas_package.sensor_type_ = MeasurementPackage::LASER;
-  	meas_package.raw_measurements_ = VectorXd(2);
+  	meas_package.raw_measurements_.resize(2);
 
-	lmarker marker = lmarker(car.position.x + noise(0.15,timestamp), car.position.y + noise(0.15,timestamp+1));
+	double n[2];
+	sensorNoise.Normal(timestamp, kLidarNoise, n, 2);
+	lmarker marker = lmarker(car.position.x + 0.15*n[0], car.position.y + 0.15*n[1]);
 	if(visualize)
 		viewer->addSphere(pcl::PointXYZ(marker.x,marker.y,3.0),0.5, 1, 0, 0,car.name+"_lmarker");
 
     meas_package.raw_measurements_ << marker.x, marker.y;
     meas_package.timestamp_ = timestamp;
 
-    car.ukf.ProcessMeasurement(meas_package);
-
     return marker;
 }
 
-// sense where a car is located using radar measurement
-rmarker Tools::radarSense(Car& car, Car ego, pcl::visualization::PCLVisualizer::Ptr& viewer, long long timestamp, bool visualize)
+// sense where a car is located using radar measurement, the caller feeds
+// meas_package to the car's filter
+rmarker Tools::radarSense(Car& car, Car ego, pcl::visualization::PCLVisualizer::Ptr& viewer, long long timestamp, bool visualize, MeasurementPackage& meas_package)
 {
 	double rho = sqrt((car.position.x-ego.position.x)*(car.position.x-ego.position.x)+(car.position.y-ego.position.y)*(car.position.y-ego.position.y));
 	double phi = atan2(car.position.y-ego.position.y,car.position.x-ego.position.x);
 	double rho_dot = (car.velocity*cos(car.angle)*rho*cos(phi) + car.velocity*sin(car.angle)*rho*sin(phi))/rho;
 
-	rmarker marker = rmarker(rho+noise(0.3,timestamp+2), phi+noise(0.03,timestamp+3), rho_dot+noise(0.3,timestamp+4));
+	double n[3];
+	sensorNoise.Normal(timestamp, kRadarNoise, n, 3);
+	rmarker marker = rmarker(rho+0.3*n[0], phi+0.03*n[1], rho_dot+0.3*n[2]);
 	if(visualize)
 	{
 		viewer->addLine(pcl::PointXYZ(ego.position.x, ego.position.y, 3.0), pcl::PointXYZ(ego.position.x+marker.rho*cos(marker.phi), ego.position.y+marker.rho*sin(marker.phi), 3.0), 1, 0, 1, car.name+"_rho");
 		viewer->addArrow(pcl::PointXYZ(ego.position.x+marker.rho*cos(marker.phi), ego.position.y+marker.rho*sin(marker.phi), 3.0), pcl::PointXYZ(ego.position.x+marker.rho*cos(marker.phi)+marker.rho_dot*cos(marker.phi), ego.position.y+marker.rho*sin(marker.phi)+marker.rho_dot*sin(marker.phi), 3.0), 1, 0, 1, car.name+"_rho_dot");
 	}
 	
-	MeasurementPackage meas_package;
 	meas_package.sensor_type_ = MeasurementPackage::RADAR;
-    meas_package.raw_measurements_ = VectorXd(3);
+    meas_package.raw_measurements_.resize(3);
     meas_package.raw_measurements_ << marker.rho, marker.phi, marker.rho_dot;
     meas_package.timestamp_ = timestamp;
 
-    car.ukf.ProcessMeasurement(meas_package);
-
     return marker;
 }
 
 // Show UKF tracking and also allow showing predicted future path
 // double time:: time ahead in the future to predict
 // int steps:: how many steps to show between present and time and future time
-void Tools::ukfResults(Car car, pcl::visualization::PCLVisualizer::Ptr& viewer, double time, int steps)
+void Tools::ukfResults(const Car& car, pcl::visualization::PCLVisualizer::Ptr& viewer, double time, int steps)
 {
-	UKF ukf = car.ukf;
-	viewer->addSphere(pcl::PointXYZ(ukf.x_[0],ukf.x_[1],3.5), 0.5, 0, 1, 0,car.name+"_ukf");
-	viewer->addArrow(pcl::PointXYZ(ukf.x_[0], ukf.x_[1],3.5), pcl::PointXYZ(ukf.x_[0]+ukf.x_[2]*cos(ukf.x_[3]),ukf.x_[1]+ukf.x_[2]*sin(ukf.x_[3]),3.5), 0, 1, 0, car.name+"_ukf_vel");
+	const UKF& ukf = car.ukf;
+	// the published state, safe to read while the filter keeps running
+	UKF::Snapshot snapshot;
+	ukf.published_.Read(&snapshot);
+	const UKF::StateVector& x = snapshot.x;
+	viewer->addSphere(pcl::PointXYZ(x[0],x[1],3.5), 0.5, 0, 1, 0,car.name+"_ukf");
+	viewer->addArrow(pcl::PointXYZ(x[0], x[1],3.5), pcl::PointXYZ(x[0]+x[2]*cos(x[3]),x[1]+x[2]*sin(x[3]),3.5), 0, 1, 0, car.name+"_ukf_vel");
 	
     if(time > 0)
 	{
-		double dt = time/steps;
-		double ct = dt;
-		while(ct <= time)
-		{            
-			ukf.Prediction(dt);
-			viewer->addSphere(pcl::PointXYZ(ukf.x_[0],ukf.x_[1],3.5), 0.5, 0, 1, 0,car.name+"_ukf"+std::to_string(ct));
+		// mean-only closed-form path from the published state, so the live
+		// filter is not read
+		forecast.resize(steps);
+		UKF::ForecastMean(snapshot.x, 0, time, steps, forecast.data());
+		for(int i = 0; i < steps; i++)
+		{
+			double ct = time*(i+1)/steps;
+			const UKF::StateVector& x = forecast[i];
+			viewer->addSphere(pcl::PointXYZ(x[0],x[1],3.5), 0.5, 0, 1, 0,car.name+"_ukf"+std::to_string(ct));
 			viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_OPACITY, 1.0-0.8*(ct/time), car.name+"_ukf"+std::to_string(ct));
 			//viewer->addArrow(pcl::PointXYZ(ukf.x_[0], ukf.x_[1],3.5), pcl::PointXYZ(ukf.x_[0]+ukf.x_[2]*cos(ukf.x_[3]),ukf.x_[1]+ukf.x_[2]*sin(ukf.x_[3]),3.5), 0, 1, 0, car.name+"_ukf_vel"+std::to_string(ct));
 			//viewer->setShapeRenderingProperties(pcl::visualization::PCL_VISUALIZER_OPACITY, 1.0-0.8*(ct/time), car.name+"_ukf_vel"+std::to_string(ct));
-			ct += dt;
 		}
 	}
 
@@ -121,6 +122,40 @@ VectorXd Tools::CalculateRMSE(const vector<VectorXd> &estimations,
 	return rmse;
 }
 
+VectorXd Tools::CalculateRMSE(const HistoryStore &history, int target) {
+
+	VectorXd rmse = VectorXd::Zero(4);
+	long long count = 0;
+
+	//accumulate squared residuals column by column, one chunk at a time
+	for(int c = 0; c < history.chunk_count(); ++c){
+		const int rows = history.chunk_rows(c);
+		const double* id = history.column(c, HistoryStore::kTarget);
+		for(int j = 0; j < 4; ++j){
+			const double* est = history.column(c, HistoryStore::Column(HistoryStore::kEstPx + j));
+			const double* gt = history.column(c, HistoryStore::Column(HistoryStore::kTruePx + j));
+			double sum = 0;
+			for(int r = 0; r < rows; ++r){
+				const double residual = est[r] - gt[r];
+				if(target < 0 || id[r] == target)
+					sum += residual*residual;
+			}
+			rmse(j) += sum;
+		}
+		for(int r = 0; r < rows; ++r)
+			count += target < 0 || id[r] == target;
+	}
+
+	if(count == 0){
+		cout << "Invalid estimation or ground_truth data" << endl;
+		return rmse;
+	}
+
+	//calculate the mean and the squared root
+	rmse = (rmse/count).array().sqrt();
+	return rmse;
+}
+
 void Tools::savePcd(typename pcl::PointCloud<pcl::PointXYZ>::Ptr cloud, std::string file)
 {
   pcl::io::savePCDFileASCII (file, *cloud);
@@ -3,6 +3,8 @@
 #include <vector>
 #include "Eigen/Dense"
 #include "render/render.h"
+#include "noise.h"
+#include "history_store.h"
 #include <pcl/io/pcd_io.h>
 
 using Eigen::MatrixXd;
@@ -40,17 +42,26 @@ class Tools {
 	virtual ~Tools();
 	
 	// Members
-	std::vector<VectorXd> estimations;
-	std::vector<VectorXd> ground_truth;
+	// evaluated estimates and ground truth of every tracked car, by column
+	HistoryStore history;
+	// predicted path buffer reused by ukfResults
+	std::vector<UKF::StateVector> forecast;
 	
-	double noise(double stddev, long long seedNum);
-	lmarker lidarSense(Car& car, pcl::visualization::PCLVisualizer::Ptr& viewer, long long timestamp, bool visualize);
-	rmarker radarSense(Car& car, Car ego, pcl::visualization::PCLVisualizer::Ptr& viewer, long long timestamp, bool visualize);
-	void ukfResults(Car car, pcl::visualization::PCLVisualizer::Ptr& viewer, double time, int steps);
+	// sensor noise, keyed by (seed, timestamp, sensor) so a frame's noise is
+	// the same however the frames are visited
+	rng::NoiseService sensorNoise;
+
+	lmarker lidarSense(Car& car, pcl::visualization::PCLVisualizer::Ptr& viewer, long long timestamp, bool visualize, MeasurementPackage& meas_package);
+	rmarker radarSense(Car& car, Car ego, pcl::visualization::PCLVisualizer::Ptr& viewer, long long timestamp, bool visualize, MeasurementPackage& meas_package);
+	void ukfResults(const Car& car, pcl::visualization::PCLVisualizer::Ptr& viewer, double time, int steps);
 	/**
 	* A helper method to calculate RMSE.
 	*/
 	VectorXd CalculateRMSE(const vector<VectorXd> &estimations, const vector<VectorXd> &ground_truth);
+	/**
+	* RMSE of the estimates in a history, of one target or of all of them.
+	*/
+	VectorXd CalculateRMSE(const HistoryStore &history, int target = -1);
 	void savePcd(typename pcl::PointCloud<pcl::PointXYZ>::Ptr cloud, std::string file);
 	pcl::PointCloud<pcl::PointXYZ>::Ptr loadPcd(std::string file);
 	
@@ -0,0 +1,495 @@
+#include "ukf_bank.h"
+#include "ctrv_kernel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// wraps an angle difference into [-pi, pi) without a data dependent loop
+inline double NormalizeAngle(double a) {
+  return a - 2. * M_PI * std::floor((a + M_PI) / (2. * M_PI));
+}
+
+// lanes are padded to a multiple of this so every plane starts aligned
+const int kLaneAlign = 8;
+
+}  // namespace
+
+UKFBank::UKFBank(int capacity)
+  : sigma_current_(false), n_(0), stride_(0) {
+  // share the single-track filter's tuning
+  const UKF tuning;
+  std_a_ = tuning.std_a_;
+  std_yawdd_ = tuning.std_yawdd_;
+  std_laspx_ = tuning.std_laspx_;
+  std_laspy_ = tuning.std_laspy_;
+  std_radr_ = tuning.std_radr_;
+  std_radphi_ = tuning.std_radphi_;
+  std_radrd_ = tuning.std_radrd_;
+
+  for (int i = 0; i < n_sig_; i++)
+    weights_[i] = UKF::Weight(i);
+
+  Reserve(capacity);
+}
+
+void UKFBank::Reserve(int capacity) {
+  int stride = (std::max(capacity, 1) + kLaneAlign - 1) / kLaneAlign * kLaneAlign;
+  if (stride <= stride_)
+    return;
+
+  std::vector<double, Eigen::aligned_allocator<double> > data(kNumPlanes * stride, 0.0);
+  // only state and covariance survive between calls, the rest is scratch
+  for (int k = kX; k < kL && n_ > 0; k++)
+    std::copy(Plane(k), Plane(k) + n_, &data[k * stride]);
+
+  data_.swap(data);
+  stride_ = stride;
+}
+
+int UKFBank::AddTrack(const MeasurementPackage& meas_package) {
+  if (n_ == stride_)
+    Reserve(2 * stride_);
+  int t = n_++;
+
+  for (int r = 0; r < n_x_; r++) {
+    Plane(kX + r)[t] = 0;
+    for (int c = 0; c < n_x_; c++)
+      Plane(kP + r * n_x_ + c)[t] = (r == c) ? 1.0 : 0.0;
+  }
+  Plane(kP + 2 * n_x_ + 2)[t] = 10;
+  Plane(kP + 3 * n_x_ + 3)[t] = 50;
+  Plane(kP + 4 * n_x_ + 4)[t] = 3;
+  sigma_current_ = false;
+
+  const double* z = meas_package.raw_measurements_.data();
+  if (meas_package.sensor_type_ == MeasurementPackage::RADAR) {
+    Plane(kX + 0)[t] = z[0] * cos(z[1]);
+    Plane(kX + 1)[t] = z[0] * sin(z[1]);
+  } else {
+    Plane(kX + 0)[t] = z[0];
+    Plane(kX + 1)[t] = z[1];
+  }
+  return t;
+}
+
+void UKFBank::Predict(double delta_t) {
+  std::fill(Plane(kDt), Plane(kDt) + n_, delta_t);
+  AugmentedSigmaPoints();
+  SigmaPointPrediction();
+  PredictMeanAndCovariance();
+  sigma_current_ = true;
+}
+
+void UKFBank::Predict(const double* delta_t) {
+  std::copy(delta_t, delta_t + n_, Plane(kDt));
+  AugmentedSigmaPoints();
+  SigmaPointPrediction();
+  PredictMeanAndCovariance();
+  sigma_current_ = true;
+}
+
+void UKFBank::CholeskyFactor() {
+  const int n = n_;
+
+  // Cholesky factor of P, lane by lane. The noise block of the augmented
+  // covariance is diagonal and constant, so only P needs factorizing.
+  for (int j = 0; j < n_x_; j++) {
+    double* Ljj = Plane(kL + j * n_x_ + j);
+    std::copy(Plane(kP + j * n_x_ + j), Plane(kP + j * n_x_ + j) + n, Ljj);
+    for (int k = 0; k < j; k++) {
+      const double* Ljk = Plane(kL + j * n_x_ + k);
+      for (int t = 0; t < n; t++)
+        Ljj[t] -= Ljk[t] * Ljk[t];
+    }
+    for (int t = 0; t < n; t++)
+      Ljj[t] = std::sqrt(std::max(Ljj[t], 1e-12));
+
+    for (int i = j + 1; i < n_x_; i++) {
+      double* Lij = Plane(kL + i * n_x_ + j);
+      std::copy(Plane(kP + i * n_x_ + j), Plane(kP + i * n_x_ + j) + n, Lij);
+      for (int k = 0; k < j; k++) {
+        const double* Lik = Plane(kL + i * n_x_ + k);
+        const double* Ljk = Plane(kL + j * n_x_ + k);
+        for (int t = 0; t < n; t++)
+          Lij[t] -= Lik[t] * Ljk[t];
+      }
+      for (int t = 0; t < n; t++)
+        Lij[t] /= Ljj[t];
+    }
+  }
+}
+
+void UKFBank::AugmentedSigmaPoints() {
+  const int n = n_;
+  CholeskyFactor();
+
+  const double scale = std::sqrt(UKF::SigmaPoints::lambda + n_aug_);
+
+  // state rows: mean everywhere, +-scale*L(r, k) in the columns of state k
+  for (int r = 0; r < n_x_; r++) {
+    const double* x = Plane(kX + r);
+    double* row = SigmaRow(kXsigAug, r);
+    for (int i = 0; i < n_sig_; i++)
+      std::copy(x, x + n, row + i * stride_);
+    for (int k = 0; k <= r; k++) {
+      const double* Lrk = Plane(kL + r * n_x_ + k);
+      double* plus = row + (k + 1) * stride_;
+      double* minus = row + (k + 1 + n_aug_) * stride_;
+      for (int t = 0; t < n; t++) {
+        plus[t] += scale * Lrk[t];
+        minus[t] -= scale * Lrk[t];
+      }
+    }
+  }
+
+  // noise rows: zero except +-scale*std in their own columns
+  const double std_noise[2] = {std_a_, std_yawdd_};
+  for (int r = n_x_; r < n_aug_; r++) {
+    double* row = SigmaRow(kXsigAug, r);
+    std::fill(row, row + n_sig_ * stride_, 0.0);
+    std::fill(row + (r + 1) * stride_, row + (r + 1) * stride_ + n, scale * std_noise[r - n_x_]);
+    std::fill(row + (r + 1 + n_aug_) * stride_, row + (r + 1 + n_aug_) * stride_ + n, -scale * std_noise[r - n_x_]);
+  }
+}
+
+void UKFBank::SigmaPointPrediction() {
+  const int n = n_;
+  const double* dt = Plane(kDt);
+
+  // one kernel call per sigma point, lanes run across tracks
+  for (int i = 0; i < n_sig_; i++) {
+    const int o = i * stride_;
+    const double* rows_in[n_aug_];
+    double* rows_out[n_x_];
+    for (int r = 0; r < n_aug_; r++)
+      rows_in[r] = SigmaRow(kXsigAug, r) + o;
+    for (int r = 0; r < n_x_; r++)
+      rows_out[r] = SigmaRow(kXsigPred, r) + o;
+    ctrv::PredictSigmaPoints(rows_in, rows_out, dt, n);
+  }
+}
+
+void UKFBank::PredictMeanAndCovariance() {
+  const int n = n_;
+
+  //predicted state mean
+  for (int r = 0; r < n_x_; r++) {
+    double* x = Plane(kX + r);
+    const double* row = SigmaRow(kXsigPred, r);
+    std::fill(x, x + n, 0.0);
+    for (int i = 0; i < n_sig_; i++) {
+      const double w = weights_[i];
+      const double* xs = row + i * stride_;
+      for (int t = 0; t < n; t++)
+        x[t] += w * xs[t];
+    }
+  }
+
+  CenterSigmaPoints();
+
+  //predicted state covariance matrix, upper triangle mirrored
+  for (int r = 0; r < n_x_; r++) {
+    for (int c = r; c < n_x_; c++) {
+      double* P = Plane(kP + r * n_x_ + c);
+      std::fill(P, P + n, 0.0);
+      for (int i = 0; i < n_sig_; i++) {
+        const double w = weights_[i];
+        const double* dr = SigmaRow(kXdiff, r) + i * stride_;
+        const double* dc = SigmaRow(kXdiff, c) + i * stride_;
+        for (int t = 0; t < n; t++)
+          P[t] += w * dr[t] * dc[t];
+      }
+      if (c != r)
+        std::copy(P, P + n, Plane(kP + c * n_x_ + r));
+    }
+  }
+}
+
+void UKFBank::CenterSigmaPoints() {
+  const int n = n_;
+
+  //state differences, kept for the cross correlation of the next update
+  for (int r = 0; r < n_x_; r++) {
+    const double* x = Plane(kX + r);
+    for (int i = 0; i < n_sig_; i++) {
+      const double* xs = SigmaRow(kXsigPred, r) + i * stride_;
+      double* xd = SigmaRow(kXdiff, r) + i * stride_;
+      if (r == 3) {
+        for (int t = 0; t < n; t++)
+          xd[t] = NormalizeAngle(xs[t] - x[t]);
+      } else {
+        for (int t = 0; t < n; t++)
+          xd[t] = xs[t] - x[t];
+      }
+    }
+  }
+}
+
+void UKFBank::RedrawSigmaPoints() {
+  const int n = n_;
+  CholeskyFactor();
+
+  //same spread as AugmentedSigmaPoints, the noise columns stay at the mean
+  //since the noise does not act over a zero time step
+  const double scale = std::sqrt(UKF::SigmaPoints::lambda + n_aug_);
+  for (int r = 0; r < n_x_; r++) {
+    const double* x = Plane(kX + r);
+    double* row = SigmaRow(kXsigPred, r);
+    for (int i = 0; i < n_sig_; i++)
+      std::copy(x, x + n, row + i * stride_);
+    for (int k = 0; k <= r; k++) {
+      const double* Lrk = Plane(kL + r * n_x_ + k);
+      double* plus = row + (k + 1) * stride_;
+      double* minus = row + (k + 1 + n_aug_) * stride_;
+      for (int t = 0; t < n; t++) {
+        plus[t] += scale * Lrk[t];
+        minus[t] -= scale * Lrk[t];
+      }
+    }
+  }
+
+  CenterSigmaPoints();
+  sigma_current_ = true;
+}
+
+void UKFBank::UpdateLidar(const double* px, const double* py, const unsigned char* active) {
+  const int n = n_;
+
+  // The lidar model is linear, so its unscented transform is exact: the
+  // predicted measurement is x[0..1], S is P[0..1][0..1] + R and the cross
+  // correlation is P[:][0..1].
+  const double R[2] = {std_laspx_ * std_laspx_, std_laspy_ * std_laspy_};
+  for (int r = 0; r < 2; r++) {
+    for (int c = 0; c < 2; c++) {
+      double* S = Plane(kS + r * 3 + c);
+      std::copy(Plane(kP + r * n_x_ + c), Plane(kP + r * n_x_ + c) + n, S);
+      if (r == c) {
+        for (int t = 0; t < n; t++)
+          S[t] += R[r];
+      }
+    }
+  }
+  for (int r = 0; r < n_x_; r++)
+    for (int c = 0; c < 2; c++)
+      std::copy(Plane(kP + r * n_x_ + c), Plane(kP + r * n_x_ + c) + n, Plane(kTc + r * 3 + c));
+
+  const double* z[2] = {px, py};
+  for (int r = 0; r < 2; r++) {
+    const double* x = Plane(kX + r);
+    double* y = Plane(kY + r);
+    for (int t = 0; t < n; t++)
+      y[t] = z[r][t] - x[t];
+  }
+
+  FillMask(active);
+  ApplyUpdate(2);
+}
+
+void UKFBank::UpdateRadar(const double* rho, const double* phi, const double* rho_dot, const unsigned char* active) {
+  const int n = n_;
+
+  //an earlier update of this frame moved the state off the sigma points
+  if (!sigma_current_)
+    RedrawSigmaPoints();
+
+  //transform sigma points into measurement space
+  for (int i = 0; i < n_sig_; i++) {
+    const int o = i * stride_;
+    const double* rows_in[4];
+    double* rows_out[3];
+    for (int r = 0; r < 4; r++)
+      rows_in[r] = SigmaRow(kXsigPred, r) + o;
+    for (int r = 0; r < 3; r++)
+      rows_out[r] = SigmaRow(kZdiff, r) + o;
+    ctrv::RadarMeasurement(rows_in, rows_out, n);
+  }
+
+  //mean predicted measurement, then center the sigma points on it
+  for (int r = 0; r < 3; r++) {
+    double* z_pred = Plane(kZpred + r);
+    double* row = SigmaRow(kZdiff, r);
+    std::fill(z_pred, z_pred + n, 0.0);
+    for (int i = 0; i < n_sig_; i++) {
+      const double w = weights_[i];
+      const double* zs = row + i * stride_;
+      for (int t = 0; t < n; t++)
+        z_pred[t] += w * zs[t];
+    }
+    for (int i = 0; i < n_sig_; i++) {
+      double* zs = row + i * stride_;
+      if (r == 1) {
+        for (int t = 0; t < n; t++)
+          zs[t] = NormalizeAngle(zs[t] - z_pred[t]);
+      } else {
+        for (int t = 0; t < n; t++)
+          zs[t] -= z_pred[t];
+      }
+    }
+  }
+
+  //innovation covariance matrix S
+  const double R[3] = {std_radr_ * std_radr_, std_radphi_ * std_radphi_, std_radrd_ * std_radrd_};
+  for (int r = 0; r < 3; r++) {
+    for (int c = r; c < 3; c++) {
+      double* S = Plane(kS + r * 3 + c);
+      std::fill(S, S + n, r == c ? R[r] : 0.0);
+      for (int i = 0; i < n_sig_; i++) {
+        const double w = weights_[i];
+        const double* dr = SigmaRow(kZdiff, r) + i * stride_;
+        const double* dc = SigmaRow(kZdiff, c) + i * stride_;
+        for (int t = 0; t < n; t++)
+          S[t] += w * dr[t] * dc[t];
+      }
+      if (c != r)
+        std::copy(S, S + n, Plane(kS + c * 3 + r));
+    }
+  }
+
+  //calculate cross correlation matrix
+  for (int r = 0; r < n_x_; r++) {
+    for (int c = 0; c < 3; c++) {
+      double* Tc = Plane(kTc + r * 3 + c);
+      std::fill(Tc, Tc + n, 0.0);
+      for (int i = 0; i < n_sig_; i++) {
+        const double w = weights_[i];
+        const double* dx = SigmaRow(kXdiff, r) + i * stride_;
+        const double* dz = SigmaRow(kZdiff, c) + i * stride_;
+        for (int t = 0; t < n; t++)
+          Tc[t] += w * dx[t] * dz[t];
+      }
+    }
+  }
+
+  //residual
+  const double* z[3] = {rho, phi, rho_dot};
+  for (int r = 0; r < 3; r++) {
+    const double* z_pred = Plane(kZpred + r);
+    double* y = Plane(kY + r);
+    if (r == 1) {
+      for (int t = 0; t < n; t++)
+        y[t] = NormalizeAngle(z[r][t] - z_pred[t]);
+    } else {
+      for (int t = 0; t < n; t++)
+        y[t] = z[r][t] - z_pred[t];
+    }
+  }
+
+  FillMask(active);
+  ApplyUpdate(3);
+}
+
+void UKFBank::FillMask(const unsigned char* active) {
+  double* m = Plane(kMask);
+  if (active == NULL) {
+    std::fill(m, m + n_, 1.0);
+  } else {
+    for (int t = 0; t < n_; t++)
+      m[t] = active[t] ? 1.0 : 0.0;
+  }
+}
+
+void UKFBank::ApplyUpdate(int n_z) {
+  const int n = n_;
+  const double* m = Plane(kMask);
+  sigma_current_ = false;
+
+  // closed form inverse of the symmetric n_z x n_z innovation covariance
+  if (n_z == 2) {
+    const double* a = Plane(kS + 0);
+    const double* b = Plane(kS + 1);
+    const double* d = Plane(kS + 4);
+    double* i00 = Plane(kSinv + 0);
+    double* i01 = Plane(kSinv + 1);
+    double* i10 = Plane(kSinv + 3);
+    double* i11 = Plane(kSinv + 4);
+    for (int t = 0; t < n; t++) {
+      const double inv_det = 1.0 / (a[t] * d[t] - b[t] * b[t]);
+      i00[t] = d[t] * inv_det;
+      i01[t] = -b[t] * inv_det;
+      i10[t] = i01[t];
+      i11[t] = a[t] * inv_det;
+    }
+  } else {
+    const double* s00 = Plane(kS + 0);
+    const double* s01 = Plane(kS + 1);
+    const double* s02 = Plane(kS + 2);
+    const double* s11 = Plane(kS + 4);
+    const double* s12 = Plane(kS + 5);
+    const double* s22 = Plane(kS + 8);
+    double* inv[9];
+    for (int k = 0; k < 9; k++)
+      inv[k] = Plane(kSinv + k);
+    for (int t = 0; t < n; t++) {
+      const double c00 = s11[t] * s22[t] - s12[t] * s12[t];
+      const double c01 = s02[t] * s12[t] - s01[t] * s22[t];
+      const double c02 = s01[t] * s12[t] - s02[t] * s11[t];
+      const double c11 = s00[t] * s22[t] - s02[t] * s02[t];
+      const double c12 = s01[t] * s02[t] - s00[t] * s12[t];
+      const double c22 = s00[t] * s11[t] - s01[t] * s01[t];
+      const double inv_det = 1.0 / (s00[t] * c00 + s01[t] * c01 + s02[t] * c02);
+      inv[0][t] = c00 * inv_det;
+      inv[1][t] = inv[3][t] = c01 * inv_det;
+      inv[2][t] = inv[6][t] = c02 * inv_det;
+      inv[4][t] = c11 * inv_det;
+      inv[5][t] = inv[7][t] = c12 * inv_det;
+      inv[8][t] = c22 * inv_det;
+    }
+  }
+
+  //Kalman gain K = Tc * S^-1. Inactive tracks are skipped by selects rather
+  //than a zero gain, since anything in their lanes may be NaN and NaN*0 is NaN
+  for (int r = 0; r < n_x_; r++) {
+    for (int c = 0; c < n_z; c++) {
+      double* K = Plane(kK + r * 3 + c);
+      std::fill(K, K + n, 0.0);
+      for (int k = 0; k < n_z; k++) {
+        const double* Tc = Plane(kTc + r * 3 + k);
+        const double* Si = Plane(kSinv + k * 3 + c);
+        for (int t = 0; t < n; t++)
+          K[t] += Tc[t] * Si[t];
+      }
+    }
+  }
+
+  //update state mean
+  for (int r = 0; r < n_x_; r++) {
+    double* x = Plane(kX + r);
+    for (int c = 0; c < n_z; c++) {
+      const double* K = Plane(kK + r * 3 + c);
+      const double* y = Plane(kY + c);
+      for (int t = 0; t < n; t++)
+        x[t] += m[t] != 0 ? K[t] * y[t] : 0.0;
+    }
+  }
+
+  //update covariance, K*S*K^T == K*Tc^T
+  for (int r = 0; r < n_x_; r++) {
+    for (int c = r; c < n_x_; c++) {
+      double* P = Plane(kP + r * n_x_ + c);
+      for (int k = 0; k < n_z; k++) {
+        const double* K = Plane(kK + r * 3 + k);
+        const double* Tc = Plane(kTc + c * 3 + k);
+        for (int t = 0; t < n; t++)
+          P[t] -= m[t] != 0 ? K[t] * Tc[t] : 0.0;
+      }
+      if (c != r)
+        std::copy(P, P + n, Plane(kP + c * n_x_ + r));
+    }
+  }
+}
+
+UKF::StateVector UKFBank::State(int track) const {
+  UKF::StateVector x;
+  for (int r = 0; r < n_x_; r++)
+    x(r) = Plane(kX + r)[track];
+  return x;
+}
+
+UKF::StateMatrix UKFBank::Covariance(int track) const {
+  UKF::StateMatrix P;
+  for (int r = 0; r < n_x_; r++)
+    for (int c = 0; c < n_x_; c++)
+      P(r, c) = Plane(kP + r * n_x_ + c)[track];
+  return P;
+}
@@ -0,0 +1,156 @@
+#ifndef UKF_BANK_H
+#define UKF_BANK_H
+
+#include <vector>
+#include "Eigen/Dense"
+#include "measurement_package.h"
+#include "ukf.h"
+
+/**
+ * Bank of CTRV Unscented Kalman filters stored structure-of-arrays.
+ *
+ * Every scalar of every track (state, covariance, sigma points and the
+ * update intermediates) lives in a "plane": a contiguous array with one lane
+ * per track. A sigma point matrix row is n_sig_ consecutive planes, so the
+ * CTRV and measurement arithmetic runs over all tracks (and all sigma points)
+ * in straight loops the compiler can vectorize.
+ *
+ * Usage per frame: Predict once for all tracks, then any number of
+ * UpdateLidar/UpdateRadar calls with one measurement per track. The first
+ * radar update after Predict consumes its sigma points; one after another
+ * update first redraws them around the updated state, like
+ * UKFFixed::ProcessMeasurements does within a batch.
+ */
+class UKFBank {
+ public:
+  static const int n_x_ = UKF::n_x_;
+  static const int n_aug_ = UKF::n_aug_;
+  static const int n_sig_ = UKF::n_sig_;
+
+  /**
+   * Constructor
+   * @param {int} capacity: number of tracks to reserve room for
+   */
+  explicit UKFBank(int capacity = 64);
+
+  /**
+   * Adds a track initialized from its first measurement, the same way
+   * UKF::ProcessMeasurement initializes a filter.
+   * @param {MeasurementPackage} meas_package: first measurement of the track
+   * @return index of the new track
+   */
+  int AddTrack(const MeasurementPackage& meas_package);
+
+  /**
+   * Number of tracks in the bank
+   */
+  int size() const { return n_; }
+
+  /**
+   * Makes room for at least capacity tracks, keeping the current tracks.
+   */
+  void Reserve(int capacity);
+
+  /**
+   * Predicts all tracks by the same time step.
+   * @param {double} delta_t: time step in s
+   */
+  void Predict(double delta_t);
+
+  /**
+   * Predicts every track by its own time step.
+   * @param {const double*} delta_t: size() time steps in s
+   */
+  void Predict(const double* delta_t);
+
+  /**
+   * Updates all tracks with one lidar measurement each.
+   * @param {const double*} px, py: size() measured positions
+   * 		  {const unsigned char*} active: optional mask, tracks with a zero
+   * 		  entry are left unchanged
+   */
+  void UpdateLidar(const double* px, const double* py, const unsigned char* active = NULL);
+
+  /**
+   * Updates all tracks with one radar measurement each.
+   * @param {const double*} rho, phi, rho_dot: size() measured values
+   * 		  {const unsigned char*} active: optional mask, tracks with a zero
+   * 		  entry are left unchanged
+   */
+  void UpdateRadar(const double* rho, const double* phi, const double* rho_dot, const unsigned char* active = NULL);
+
+  /**
+   * State and covariance of one track
+   */
+  UKF::StateVector State(int track) const;
+  UKF::StateMatrix Covariance(int track) const;
+
+  // Process noise standard deviation longitudinal acceleration in m/s^2
+  double std_a_;
+
+  // Process noise standard deviation yaw acceleration in rad/s^2
+  double std_yawdd_;
+
+  // Laser measurement noise standard deviations in m
+  double std_laspx_;
+  double std_laspy_;
+
+  // Radar measurement noise standard deviations
+  double std_radr_;
+  double std_radphi_;
+  double std_radrd_;
+
+ private:
+  // plane layout of the buffer, every plane is stride_ doubles
+  enum {
+    kX = 0,                           // state, n_x_ planes
+    kP = kX + n_x_,                   // covariance, n_x_*n_x_ planes
+    kL = kP + n_x_ * n_x_,            // Cholesky factor of P, n_x_*n_x_ planes
+    kXsigAug = kL + n_x_ * n_x_,      // augmented sigma points, n_aug_ rows
+    kXsigPred = kXsigAug + n_aug_ * n_sig_, // predicted sigma points, n_x_ rows
+    kXdiff = kXsigPred + n_x_ * n_sig_,     // centered predicted sigma points
+    kZdiff = kXdiff + n_x_ * n_sig_,  // centered measurement sigma points, 3 rows
+    kZpred = kZdiff + 3 * n_sig_,     // predicted measurement
+    kS = kZpred + 3,                  // innovation covariance, 3x3
+    kSinv = kS + 9,                   // its inverse
+    kTc = kSinv + 9,                  // cross correlation, n_x_x3
+    kK = kTc + n_x_ * 3,              // gain, n_x_x3
+    kY = kK + n_x_ * 3,               // measurement residual
+    kDt = kY + 3,                     // time step per track
+    kMask = kDt + 1,                  // 1 for tracks taking part in an update
+    kNumPlanes = kMask + 1
+  };
+
+  double* Plane(int k) { return &data_[k * stride_]; }
+  const double* Plane(int k) const { return &data_[k * stride_]; }
+
+  // first plane of row r of a sigma point block starting at plane base
+  double* SigmaRow(int base, int r) { return Plane(base + r * n_sig_); }
+
+  void CholeskyFactor();
+  void AugmentedSigmaPoints();
+  void SigmaPointPrediction();
+  void PredictMeanAndCovariance();
+  // Xdiff from the predicted sigma points and the current state
+  void CenterSigmaPoints();
+  // predicted sigma points around the current state and covariance, without
+  // moving them in time
+  void RedrawSigmaPoints();
+  void FillMask(const unsigned char* active);
+  void ApplyUpdate(int n_z);
+
+  // weights of sigma points
+  double weights_[n_sig_];
+
+  // whether the predicted sigma points were drawn from the current state,
+  // false once an update has moved it
+  bool sigma_current_;
+
+  // number of tracks, allocated lanes per plane
+  int n_;
+  int stride_;
+
+  std::vector<double, Eigen::aligned_allocator<double> > data_;
+};
+
+#endif  // UKF_BANK_H
@@ -0,0 +1,1182 @@
+#ifndef UKF_FIXED_H
+#define UKF_FIXED_H
+
+#include "Eigen/Dense"
+#include "measurement_package.h"
+#include "alloc_check.h"
+#include "motion_models.h"
+#include "sensor_models.h"
+#include "sigma_points.h"
+#include "sqrt_ukf.h"
+#include "state_snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * Unscented Kalman filter with all dimensions fixed at compile time. Every matrix is a fixed-size Eigen type, so the filter
+ * never touches the heap and the sigma point loops have constant trip counts.
+ *
+ * NX   : state dimension [pos1 pos2 vel_abs yaw_angle yaw_rate ...]
+ * NAUG : augmented state dimension (state + longitudinal and yaw acceleration
+ *        noise)
+ *
+ * Members use Eigen::DontAlign so the filter can be stored by value inside
+ * std::vector<Car> without an aligned allocator. Sigma point matrices are
+ * row-major so each state component is a contiguous row for the vectorized
+ * kernels in motion_models.h and ctrv_kernel.h.
+ *
+ * With use_sqrt_ set the filter runs as a square-root UKF: it carries the
+ * Cholesky factor S_ of P_ and updates it with QR and rank-1 updates (see
+ * sqrt_ukf.h) instead of refactorizing P every prediction.
+ *
+ * With SetHistoryDepth the filter keeps its recent measurements and states,
+ * and a measurement older than the current state is inserted at its time
+ * and the newer measurements are re-run on top of it.
+ *
+ * Prediction is lazy: time_us_ moves with every measurement, but x_ and P_
+ * are only predicted when an update needs them or StateAt asks for them.
+ * Until then pending_dt_ holds the time they lag behind time_us_, so
+ * measurements of a disabled sensor and coasting tracks cost nothing.
+ *
+ * T    : scalar of the state, covariance and gain
+ * TSig : scalar of the sigma points, T by default. UKFFixed<.., double, float>
+ *        propagates and maps the sigma points in float, twice the SIMD lanes,
+ *        and accumulates the moments and the update in double.
+ * SigmaSet : sigma point set of the augmented state, see sigma_points.h.
+ *        sigma::Symmetric (2*NAUG+1 points) by default, sigma::SphericalSimplex
+ *        needs NAUG+2.
+ * Motion : process model, see motion_models.h. motion::CTRV by default.
+ *
+ * After every measurement and StateAt the filter publishes its state to
+ * published_, which other threads read without blocking the filter (see
+ * state_snapshot.h); x_ and P_ themselves belong to the tracking thread.
+ *
+ * In builds configured with UKF_CHECK_NO_MALLOC, ProcessMeasurement aborts
+ * if it touches the heap (see alloc_check.h).
+ */
+template <int NX, int NAUG, typename T = double, typename TSig = T,
+          template <int> class SigmaSet = sigma::Symmetric, class Motion = motion::CTRV>
+class UKFFixed {
+ public:
+  static_assert(NX >= 5, "state needs at least [px py v yaw yawd]");
+  static_assert(NX >= Motion::n_core, "state is smaller than the motion model");
+  static_assert(NAUG == NX + 2, "augmented state adds two process noise terms");
+
+  // State dimension
+  static const int n_x_ = NX;
+
+  // Augmented state dimension
+  static const int n_aug_ = NAUG;
+
+  // Sigma point set of the augmented state
+  typedef SigmaSet<NAUG> SigmaPoints;
+
+  // Number of sigma points
+  static const int n_sig_ = SigmaPoints::n_sig;
+
+  typedef T Scalar;
+  typedef TSig SigmaScalar;
+
+  typedef Eigen::Matrix<T, NX, 1, Eigen::DontAlign> StateVector;
+  typedef Eigen::Matrix<T, NX, NX, Eigen::DontAlign> StateMatrix;
+  typedef Eigen::Matrix<TSig, NX, n_sig_, Eigen::RowMajor | Eigen::DontAlign> SigmaMatrix;
+  typedef Eigen::Matrix<T, NX, n_sig_, Eigen::RowMajor | Eigen::DontAlign> DiffMatrix;
+  typedef Eigen::Matrix<T, n_sig_, 1, Eigen::DontAlign> WeightVector;
+  typedef Eigen::Matrix<T, NAUG, 1, Eigen::DontAlign> AugVector;
+  typedef Eigen::Matrix<T, NAUG, NAUG, Eigen::DontAlign> AugMatrix;
+  typedef Eigen::Matrix<TSig, NAUG, n_sig_, Eigen::RowMajor | Eigen::DontAlign> AugSigmaMatrix;
+  typedef StateSnapshot<NX, T> Snapshot;
+
+  /**
+   * Scratch storage of the closed-form update of a linear NZ-dimensional
+   * sensor: residual, innovation covariance and its inverse, P*H^T and gain.
+   */
+  template <int NZ>
+  struct LinearWorkspace {
+    Eigen::Matrix<T, NZ, 1, Eigen::DontAlign> z_diff;
+    Eigen::Matrix<T, NZ, NZ, Eigen::DontAlign> S;
+    Eigen::Matrix<T, NZ, NZ, Eigen::DontAlign> Si;
+    Eigen::Matrix<T, NX, NZ, Eigen::DontAlign> PHt;
+    Eigen::Matrix<T, NX, NZ, Eigen::DontAlign> K;
+  };
+
+  /**
+   * Scratch storage of the unscented update of an NZ-dimensional sensor:
+   * predicted measurement, sigma points in measurement space and centered,
+   * innovation covariance and its inverse, cross correlation, gain and
+   * residual, plus the
+   * innovation factorizer of the square-root mode.
+   */
+  template <int NZ>
+  struct UnscentedWorkspace {
+    Eigen::Matrix<T, NZ, 1, Eigen::DontAlign> z_pred;
+    Eigen::Matrix<TSig, NZ, n_sig_, Eigen::RowMajor | Eigen::DontAlign> Zsig;
+    Eigen::Matrix<T, NZ, n_sig_, Eigen::RowMajor | Eigen::DontAlign> Zdiff;
+    Eigen::Matrix<T, NZ, NZ, Eigen::DontAlign> S;
+    Eigen::Matrix<T, NZ, NZ, Eigen::DontAlign> Si;
+    Eigen::Matrix<T, NX, NZ, Eigen::DontAlign> Tc;
+    Eigen::Matrix<T, NX, NZ, Eigen::DontAlign> K;
+    Eigen::Matrix<T, NZ, 1, Eigen::DontAlign> z_diff;
+    SqrtFactorizer<NZ, n_sig_, T> sqrt;
+  };
+
+  /**
+   * Scratch storage owned by the filter. Every predict/update step writes
+   * its intermediate results here in place instead of building temporaries
+   * and copying them out.
+   */
+  struct Workspace {
+    // square root of the augmented covariance used for the sigma points
+    AugMatrix L_aug;
+
+    // augmented sigma points
+    AugSigmaMatrix Xsig_aug;
+
+    // centered predicted sigma points; square-root mode: factorizer of the
+    // state covariance; factorization of P for the fallback and for redraws
+    DiffMatrix Xdiff;
+    StateMatrix L_state;
+    SqrtFactorizer<NX, n_sig_, T> sqrt_state;
+    Eigen::LLT<StateMatrix> state_llt;
+
+    // per sensor update scratch
+    LinearWorkspace<2> lidar;
+    UnscentedWorkspace<3> radar;
+  };
+
+  /**
+   * A processed measurement and the state right after it.
+   */
+  struct HistoryEntry {
+    MeasurementPackage meas_package;
+    StateVector x;
+    StateMatrix P;
+    StateMatrix S;
+    double pending_dt;
+  };
+
+  /**
+   * Weight of sigma point i, fixed by the sigma point set.
+   * @param {int} i: sigma point index
+   */
+  static constexpr double Weight(int i) {
+    return SigmaPoints::Weight(i);
+  }
+
+  /**
+   * Constructor
+   */
+  UKFFixed();
+
+  /**
+   * Destructor
+   */
+  virtual ~UKFFixed() {}
+
+  /**
+   * ProcessMeasurement
+   * @param meas_package The latest measurement data of either radar or laser
+   */
+  void ProcessMeasurement(const MeasurementPackage& meas_package);
+
+  enum ForecastMode {
+    // unscented prediction, means and covariances
+    FORECAST_UNSCENTED,
+    // noise-free closed-form motion of x_, means only, for display
+    FORECAST_MEAN_ONLY
+  };
+
+  /**
+   * Moves the filter to timestamp without predicting, the prediction is
+   * added to pending_dt_.
+   * @param {long long} timestamp: time in us, not older than time_us_
+   */
+  void CoastTo(long long timestamp);
+
+  /**
+   * Moves the filter to timestamp and runs the pending prediction, so x_
+   * and P_ are the state at that time.
+   * @param {long long} timestamp: time in us, not older than time_us_
+   * @return x_
+   */
+  const StateVector& StateAt(long long timestamp);
+
+  /**
+   * Replaces the state and covariance, refreshing S_ in square-root mode.
+   * Used by IMM mixing.
+   * @param {StateVector} x: new state
+   * 		  {StateMatrix} P: new covariance
+   */
+  void SetState(const StateVector& x, const StateMatrix& P);
+
+  /**
+   * Publishes x_, P_ and the time they are true to published_.
+   */
+  void Publish();
+
+  /**
+   * Predicts x_ and P_ over pending_dt_ and clears it. Leaves Xsig_pred_
+   * drawn around the predicted state for an unscented update.
+   */
+  void PredictPending();
+
+  /**
+   * Predicts the state at steps evenly spaced times up to horizon without
+   * changing the filter. In unscented mode one sigma set is drawn and taken
+   * straight to every time, so there is a single Cholesky per call.
+   * Pending prediction is included, the times count from time_us_.
+   * @param {double} horizon: time ahead of time_us_ of the last output in s
+   * 		  {int} steps: number of outputs, at horizon*i/steps for i = 1..steps
+   * 		  {StateVector*} means: steps predicted states
+   * 		  {StateMatrix*} covs: optional steps predicted covariances, only
+   * 		  written in FORECAST_UNSCENTED mode
+   * 		  {ForecastMode} mode: see ForecastMode
+   */
+  void Forecast(double horizon, int steps, StateVector* means, StateMatrix* covs = NULL,
+                ForecastMode mode = FORECAST_UNSCENTED) const;
+
+  /**
+   * FORECAST_MEAN_ONLY for any state rather than x_, such as a published
+   * snapshot, so it reads nothing of a filter.
+   * @param {StateVector} x: state to move
+   * 		  {double} start: time the horizon counts from, in s after the
+   * 		  time of x
+   * 		  {double} horizon, {int} steps, {StateVector*} means: as in Forecast
+   */
+  static void ForecastMean(const StateVector& x, double start, double horizon, int steps, StateVector* means);
+
+  /**
+   * Sets how many processed measurements are kept for out-of-sequence
+   * handling. A measurement older than time_us_ is inserted among them and
+   * the filter re-runs from there; one older than all of them is dropped.
+   * With depth 0 (the default) every late measurement is dropped. Allocates
+   * and clears the history, so call it before processing.
+   * @param {int} depth: number of measurements to keep
+   */
+  void SetHistoryDepth(int depth);
+
+  /**
+   * Processes measurements in order, each run of consecutive measurements
+   * that share a timestamp with a single prediction followed by their
+   * updates. A radar update after an earlier update gets its sigma points
+   * redrawn around the updated state, which is what Prediction(0) did,
+   * without running the process model.
+   * @param {const MeasurementPackage*} meas_packages:measurements
+   * 		  {int} n:number of measurements
+   */
+  void ProcessMeasurements(const MeasurementPackage* meas_packages, int n);
+
+  /**
+   * Prediction Predicts sigma points, the state, and the state covariance
+   * matrix
+   * @param delta_t Time between k and k+1 in s
+   */
+  void Prediction(double delta_t);
+
+  /**
+   * Updates the state and the state covariance matrix using a laser measurement.
+   * The lidar model is linear (H selects px and py), so this is the closed-form
+   * Kalman update instead of an unscented transform.
+   * @param meas_package The measurement at k+1
+   */
+  void UpdateLidar(const MeasurementPackage& meas_package);
+
+  /**
+   * Updates the state and the state covariance matrix using a radar measurement
+   * @param meas_package The measurement at k+1
+   */
+  void UpdateRadar(const MeasurementPackage& meas_package);
+
+  /**
+   * Initializes the state from the first measurement.
+   * @param {MeasurementPackage} meas_package:first measurement
+   */
+  void Initialize(const MeasurementPackage& meas_package);
+
+  /**
+   * Moves to the time of a measurement and, if its sensor is enabled,
+   * predicts and updates with it.
+   * @param {MeasurementPackage} meas_package:measurement not older than time_us_
+   */
+  void Step(const MeasurementPackage& meas_package);
+
+  /**
+   * Appends a processed measurement and the current state to the history,
+   * dropping the oldest entry when it is full.
+   * @param {MeasurementPackage} meas_package:processed measurement
+   */
+  void Record(const MeasurementPackage& meas_package);
+
+  /**
+   * Inserts a measurement older than time_us_ into the history and re-runs
+   * the filter from the state before it.
+   * @param {MeasurementPackage} meas_package:late measurement
+   */
+  void ProcessLate(const MeasurementPackage& meas_package);
+
+  /**
+   * ProcessMeasurement without the allocation check or clearing the update
+   * flags, for the calls that make up a ProcessMeasurements batch.
+   * @param {MeasurementPackage} meas_package:measurement
+   */
+  void ProcessSingle(const MeasurementPackage& meas_package);
+
+  /**
+   * ProcessMeasurements for one run of measurements that share a timestamp.
+   * @param {const MeasurementPackage*} meas_packages:measurements, all with
+   * 		  the same timestamp
+   * 		  {int} n:number of measurements
+   */
+  void ProcessBatch(const MeasurementPackage* meas_packages, int n);
+
+  /**
+   * History entry i, 0 being the oldest.
+   */
+  HistoryEntry& HistoryAt(int i) {
+    return history_[(history_head_ + i) % history_.size()];
+  }
+
+  /**
+   * Redraws Xsig_pred_ around the current x_ and P_ without moving them in
+   * time, for a further unscented update at the same timestamp.
+   */
+  void RedrawSigmaPoints();
+
+  /**
+   * Writes the sigma points in Xsig_pred_ centered on x_ to ws_.Xdiff.
+   */
+  void CenterSigmaPoints();
+
+  /**
+   * Closed-form Kalman update with a sensor whose H selects state components.
+   * @param {Model} model:linear sensor model, see sensor_models.h
+   * 		  {Vector} z:measurement
+   * 		  {LinearWorkspace*} w:scratch of the sensor
+   * @return NIS of the measurement
+   */
+  template <class Model>
+  double UpdateLinear(const Model& model, const typename Model::Vector& z,
+                    LinearWorkspace<Model::n_z>* w);
+
+  /**
+   * Unscented update with a nonlinear sensor: maps the predicted sigma points
+   * through the model, then updates the state with the measurement.
+   * @param {Model} model:sensor model with Measure, see sensor_models.h
+   * 		  {Vector} z:measurement
+   * 		  {UnscentedWorkspace*} w:scratch of the sensor
+   * @return NIS of the measurement
+   */
+  template <class Model>
+  double UpdateUnscented(const Model& model, const typename Model::Vector& z,
+                       UnscentedWorkspace<Model::n_z>* w);
+
+  /**
+   * Generates the augmeneted sigma points into ws_.Xsig_aug.
+   */
+  void AugmentedSigmaPoints();
+
+  /**
+   * Generates the augmeneted sigma points of x_ and P_.
+   * @param {AugMatrix*} L: square root of the augmented covariance
+   * 		  {AugSigmaMatrix*} Xsig_aug: augmented sigma points
+   */
+  void AugmentedSigmaPoints(AugMatrix* L, AugSigmaMatrix* Xsig_aug) const;
+
+  /**
+   * Transforms the augmeneted sigma points in ws_.Xsig_aug using the process
+   * equations and writes them to Xsig_pred_.
+   * @param {double }	delta_t: Time difference
+   */
+  void SigmaPointPrediction(double delta_t);
+
+  /**
+   * Transforms augmented sigma points using the process equations.
+   * @param {AugSigmaMatrix} Xsig_aug: augmented sigma points
+   * 		  {double} delta_t: Time difference
+   * 		  {SigmaMatrix*} Xsig_pred: predicted sigma points
+   */
+  static void SigmaPointPrediction(const AugSigmaMatrix& Xsig_aug, double delta_t,
+                                   SigmaMatrix* Xsig_pred);
+
+  /**
+   * Calculate the mean and covariance using the augmented sigma points.
+   * @param void
+   */
+  void PredictMeanAndCovariance(void);
+
+  /**
+   * Square-root mode part of UpdateUnscented: factors the innovation
+   * covariance from the centered measurement sigma points, applies the gain
+   * through triangular solves and downdates S_ with the columns of K*Sz.
+   * @param {Model} model:sensor model, provides the noise
+   * 		  {UnscentedWorkspace*} w:scratch holding Zdiff, S, Tc and z_diff
+   */
+  template <class Model>
+  void SqrtUpdate(const Model& model, UnscentedWorkspace<Model::n_z>* w);
+
+  /**
+   * Square-root mode: removes U*U^T from P_ by downdating S_ with the columns
+   * of U, falling back to the covariance form if S_ loses definiteness.
+   * @param {Matrix} U:NX x NZ downdate, K*Sz for a measurement update
+   */
+  template <int NZ>
+  void DowndateFactor(const Eigen::Matrix<T, NX, NZ>& U);
+
+
+  // initially set to false, set to true in first call of ProcessMeasurement
+  bool is_initialized_;
+
+  // if this is false, laser measurements will be ignored (except for init)
+  bool use_laser_;
+
+  // if this is false, radar measurements will be ignored (except for init)
+  bool use_radar_;
+
+  // if this is true the filter runs in square-root form (set before init)
+  bool use_sqrt_;
+
+  // state vector: [pos1 pos2 vel_abs yaw_angle yaw_rate] in SI units and rad
+  StateVector x_;
+
+  // state covariance matrix
+  StateMatrix P_;
+
+  // lower Cholesky factor of P_, maintained in square-root mode
+  StateMatrix S_;
+
+  // predicted sigma points matrix
+  SigmaMatrix Xsig_pred_;
+
+  // time of the last measurement or StateAt/CoastTo call, in us
+  long long time_us_;
+
+  // time x_ and P_ lag behind time_us_ until the next prediction, in s
+  double pending_dt_;
+
+  // sum of the log likelihoods of the measurement residuals since it was
+  // last cleared, for model weighting in IMM
+  double log_likelihood_;
+
+  // normalized innovation squared of the last lidar and radar update, for
+  // consistency checks
+  double nis_laser_;
+  double nis_radar_;
+
+  // whether the last ProcessMeasurement or ProcessMeasurements call ran a
+  // lidar or radar update, so nis_laser_ and nis_radar_ are from that call
+  bool laser_updated_;
+  bool radar_updated_;
+
+  // Process noise standard deviation longitudinal acceleration in m/s^2
+  double std_a_;
+
+  // Process noise standard deviation yaw acceleration in rad/s^2
+  double std_yawdd_;
+
+  // Laser measurement noise standard deviation position1 in m
+  double std_laspx_;
+
+  // Laser measurement noise standard deviation position2 in m
+  double std_laspy_;
+
+  // Radar measurement noise standard deviation radius in m
+  double std_radr_;
+
+  // Radar measurement noise standard deviation angle in rad
+  double std_radphi_;
+
+  // Radar measurement noise standard deviation radius change in m/s
+  double std_radrd_ ;
+
+  // Weights of sigma points
+  WeightVector weights_;
+
+  // Scratch storage reused by every step
+  Workspace ws_;
+
+  // last published state, for readers on other threads
+  SnapshotPublisher<Snapshot> published_;
+
+  // ring buffer of recent measurements and states, history_size_ entries
+  // starting at history_head_
+  std::vector<HistoryEntry> history_;
+  int history_head_;
+  int history_size_;
+};
+
+/**
+ * Initializes Unscented Kalman filter
+ */
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::UKFFixed() {
+  // if this is false, laser measurements will be ignored (except during init)
+  use_laser_ = true;
+
+  // if this is false, radar measurements will be ignored (except during init)
+  use_radar_ = true;
+
+  // plain UKF by default, square-root form is opt-in
+  use_sqrt_ = false;
+
+  // initial state vector
+  x_.setZero();
+
+  // initial covariance matrix
+  P_.setZero();
+  S_.setZero();
+
+  // no out-of-sequence history by default
+  history_head_ = 0;
+  history_size_ = 0;
+
+  // Process noise standard deviation longitudinal acceleration in m/s^2
+  std_a_ = 0.7;
+
+  // Process noise standard deviation yaw acceleration in rad/s^2
+  std_yawdd_ = 0.9;
+
+  /**
+   * DO NOT MODIFY measurement noise values below.
+   * These are provided by the sensor manufacturer.
+   */
+
+  // Laser measurement noise standard deviation position1 in m
+  std_laspx_ = 0.15;
+
+  // Laser measurement noise standard deviation position2 in m
+  std_laspy_ = 0.15;
+
+  // Radar measurement noise standard deviation radius in m
+  std_radr_ = 0.3;
+
+  // Radar measurement noise standard deviation angle in rad
+  std_radphi_ = 0.03;
+
+  // Radar measurement noise standard deviation radius change in m/s
+  std_radrd_ = 0.3;
+
+  /**
+   * End DO NOT MODIFY section for measurement noise values
+   */
+
+  is_initialized_ = false;
+  time_us_ = 0;
+  pending_dt_ = 0;
+  log_likelihood_ = 0;
+  nis_laser_ = 0;
+  nis_radar_ = 0;
+  laser_updated_ = false;
+  radar_updated_ = false;
+
+  // set weights they remain constant throughout the processes
+  for (int i = 0; i < n_sig_; i++) {
+    weights_(i) = Weight(i);
+  }
+
+  //Xsig_pred holds the n_sig_ points of the state for transformation
+  Xsig_pred_.setZero();
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::ProcessMeasurement(const MeasurementPackage& meas_package) {
+  // test hook: aborts in UKF_CHECK_NO_MALLOC builds if this call allocates
+  alloc_check::NoAllocScope no_alloc;
+
+  laser_updated_ = false;
+  radar_updated_ = false;
+  ProcessSingle(meas_package);
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::ProcessSingle(const MeasurementPackage& meas_package) {
+  if (!is_initialized_) {
+    Initialize(meas_package);
+  } else if (meas_package.timestamp_ < time_us_) {
+    // out of sequence: re-run from the history instead of predicting backwards
+    ProcessLate(meas_package);
+    Publish();
+    return;
+  } else {
+    Step(meas_package);
+  }
+
+  Record(meas_package);
+  Publish();
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::Initialize(const MeasurementPackage& meas_package) {
+
+  //Initialize P with identity matrix
+  P_.setIdentity();
+  P_(2,2) = 10;
+  P_(3,3) = 50;
+  P_(4,4) = 3;
+  S_ = P_.cwiseSqrt();
+
+  x_.setZero();
+  if (meas_package.sensor_type_ == MeasurementPackage::RADAR) {
+    // Convert radar from polar to cartesian coordinates and initialize state.
+    x_(0) = meas_package.raw_measurements_[0]*cos(meas_package.raw_measurements_[1]);
+    x_(1) = meas_package.raw_measurements_[0]*sin(meas_package.raw_measurements_[1]);
+  }
+  else if (meas_package.sensor_type_ == MeasurementPackage::LASER) {
+    //set the state with the initial location and zero velocity
+    x_(0) = meas_package.raw_measurements_[0];
+    x_(1) = meas_package.raw_measurements_[1];
+  }
+
+  time_us_ = meas_package.timestamp_;
+  pending_dt_ = 0;
+
+  Xsig_pred_.setZero();
+
+  // done initializing, no need to predict or update
+  is_initialized_ = true;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::Step(const MeasurementPackage& meas_package) {
+
+  CoastTo(meas_package.timestamp_);
+
+  //a disabled sensor leaves the prediction pending
+  if ((meas_package.sensor_type_ == MeasurementPackage::RADAR) && use_radar_) {
+    PredictPending();
+    UpdateRadar(meas_package);
+  } else if ((meas_package.sensor_type_ == MeasurementPackage::LASER) && use_laser_) {
+    PredictPending();
+    UpdateLidar(meas_package);
+  }
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::CoastTo(long long timestamp) {
+  //compute the time elapsed since the last measurement
+  pending_dt_ += (timestamp - time_us_) / 1000000.0;	//dt - expressed in seconds
+  time_us_ = timestamp;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+const typename UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::StateVector&
+UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::StateAt(long long timestamp) {
+  // test hook: aborts in UKF_CHECK_NO_MALLOC builds if this call allocates
+  alloc_check::NoAllocScope no_alloc;
+
+  CoastTo(timestamp);
+  if (pending_dt_ != 0)
+    PredictPending();
+  Publish();
+  return x_;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::Publish() {
+  Snapshot snapshot;
+  snapshot.timestamp = time_us_ - (long long)std::llround(pending_dt_ * 1000000.0);
+  snapshot.x = x_;
+  snapshot.P = P_;
+  published_.Publish(snapshot);
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::SetState(const StateVector& x, const StateMatrix& P) {
+  x_ = x;
+  P_ = P;
+  if (use_sqrt_) {
+    ws_.state_llt.compute(P_);
+    S_ = ws_.state_llt.matrixL();
+  }
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::PredictPending() {
+  Prediction(pending_dt_);
+  pending_dt_ = 0;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::SetHistoryDepth(int depth) {
+  history_.assign(depth, HistoryEntry());
+  history_head_ = 0;
+  history_size_ = 0;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::Record(const MeasurementPackage& meas_package) {
+  const int depth = history_.size();
+  if (depth == 0)
+    return;
+
+  if (history_size_ == depth) {
+    history_head_ = (history_head_ + 1) % depth;
+    history_size_--;
+  }
+
+  HistoryEntry& entry = HistoryAt(history_size_++);
+  entry.meas_package = meas_package;
+  entry.x = x_;
+  entry.P = P_;
+  entry.S = S_;
+  entry.pending_dt = pending_dt_;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::ProcessLate(const MeasurementPackage& meas_package) {
+  const int depth = history_.size();
+
+  //first entry newer than the late measurement
+  int k = history_size_;
+  while (k > 0 && HistoryAt(k-1).meas_package.timestamp_ > meas_package.timestamp_)
+    k--;
+
+  //the state before it is gone: drop the measurement
+  if (k == 0)
+    return;
+
+  //restore the state right before the late measurement
+  const HistoryEntry& before = HistoryAt(k-1);
+  x_ = before.x;
+  P_ = before.P;
+  S_ = before.S;
+  pending_dt_ = before.pending_dt;
+  time_us_ = before.meas_package.timestamp_;
+
+  //make room at k, dropping the oldest entry when full
+  if (history_size_ == depth) {
+    history_head_ = (history_head_ + 1) % depth;
+    history_size_--;
+    k--;
+  }
+  for (int i = history_size_; i > k; i--)
+    HistoryAt(i) = HistoryAt(i-1);
+  history_size_++;
+  HistoryAt(k).meas_package = meas_package;
+
+  //re-run the filter from there, refreshing the stored states
+  for (int i = k; i < history_size_; i++) {
+    HistoryEntry& entry = HistoryAt(i);
+    Step(entry.meas_package);
+    entry.x = x_;
+    entry.P = P_;
+    entry.S = S_;
+    entry.pending_dt = pending_dt_;
+  }
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::ProcessMeasurements(const MeasurementPackage* meas_packages, int n) {
+  // test hook: aborts in UKF_CHECK_NO_MALLOC builds if this call allocates
+  alloc_check::NoAllocScope no_alloc;
+
+  laser_updated_ = false;
+  radar_updated_ = false;
+
+  //only measurements that are truly simultaneous share a prediction
+  for (int i = 0; i < n;) {
+    int end = i + 1;
+    while (end < n && meas_packages[end].timestamp_ == meas_packages[i].timestamp_)
+      end++;
+    ProcessBatch(meas_packages + i, end - i);
+    i = end;
+  }
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::ProcessBatch(const MeasurementPackage* meas_packages, int n) {
+  //the first measurement initializes the filter
+  int first = 0;
+  if (!is_initialized_ && n > 0) {
+    ProcessSingle(meas_packages[0]);
+    first = 1;
+  }
+  if (first >= n)
+    return;
+
+  //a late batch is inserted into the history one by one
+  if (meas_packages[first].timestamp_ < time_us_) {
+    for (int i = first; i < n; i++)
+      ProcessSingle(meas_packages[i]);
+    return;
+  }
+
+  //one prediction for the whole batch, run by its first update
+  CoastTo(meas_packages[first].timestamp_);
+
+  //after the first update x_ and P_ have moved off Xsig_pred_, so a later
+  //unscented update redraws it
+  bool predicted = false;
+  for (int i = first; i < n; i++) {
+    const MeasurementPackage& meas_package = meas_packages[i];
+    if ((meas_package.sensor_type_ == MeasurementPackage::RADAR) && use_radar_) {
+      if (!predicted)
+        PredictPending();
+      else
+        RedrawSigmaPoints();
+      UpdateRadar(meas_package);
+      predicted = true;
+    } else if ((meas_package.sensor_type_ == MeasurementPackage::LASER) && use_laser_) {
+      //the linear update does not use the sigma points
+      if (!predicted)
+        PredictPending();
+      UpdateLidar(meas_package);
+      predicted = true;
+    }
+  }
+
+  //each entry carries the state after the whole batch, not after its own
+  //measurement; they share one time, so out-of-sequence replay never starts
+  //between them
+  for (int i = first; i < n; i++)
+    Record(meas_packages[i]);
+  Publish();
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::Prediction(double delta_t) {
+  // Find the augmented sigma points
+  AugmentedSigmaPoints();
+  // Sigma point transformation using the process equation
+  SigmaPointPrediction(delta_t);
+  // Mean and Covariance prediction of the transformed sigma points
+  PredictMeanAndCovariance();
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::AugmentedSigmaPoints() {
+  AugmentedSigmaPoints(&ws_.L_aug, &ws_.Xsig_aug);
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::AugmentedSigmaPoints(AugMatrix* L, AugSigmaMatrix* Xsig_aug) const {
+
+  //create augmented mean state
+  AugVector x_aug;
+  x_aug.setZero();
+  x_aug.template head<NX>() = x_;
+
+  //create square root matrix
+  if (use_sqrt_) {
+    // the augmented factor is block diagonal: S_ and the noise deviations
+    L->setZero();
+    L->template topLeftCorner<NX, NX>() = S_;
+    (*L)(NX, NX) = std_a_;
+    (*L)(NX+1, NX+1) = std_yawdd_;
+  } else {
+    //create augmented covariance matrix
+    AugMatrix P_aug;
+    P_aug.setZero();
+    P_aug.template topLeftCorner<NX, NX>() = P_;
+    P_aug(NX, NX) = std_a_*std_a_;
+    P_aug(NX+1, NX+1) = std_yawdd_*std_yawdd_;
+
+    Eigen::LLT<AugMatrix> llt(P_aug);
+    *L = llt.matrixL();
+  }
+
+  //create augmented sigma points
+  Xsig_aug->colwise() = x_aug.template cast<TSig>();
+  SigmaPoints::Spread(*L, Xsig_aug);
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::SigmaPointPrediction(double delta_t) {
+  SigmaPointPrediction(ws_.Xsig_aug, delta_t, &Xsig_pred_);
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::SigmaPointPrediction(const AugSigmaMatrix& Xsig_aug, double delta_t,
+                                              SigmaMatrix* Xsig_pred) {
+
+  const int n_core = Motion::n_core;
+
+  // states beyond the motion model core are carried through unchanged
+  if (NX > n_core)
+    Xsig_pred->bottomRows(NX - n_core) = Xsig_aug.middleRows(n_core, NX - n_core);
+
+  //predict all sigma points at once, one row per state component
+  const TSig* rows_in[n_core + 2];
+  TSig* rows_out[n_core];
+  for (int r = 0; r < n_core; r++) {
+    rows_in[r] = Xsig_aug.row(r).data();
+    rows_out[r] = Xsig_pred->row(r).data();
+  }
+  rows_in[n_core] = Xsig_aug.row(NX).data();
+  rows_in[n_core+1] = Xsig_aug.row(NX+1).data();
+  motion::PredictSigmaPoints<Motion>(rows_in, rows_out, delta_t, n_sig_);
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::Forecast(double horizon, int steps, StateVector* means, StateMatrix* covs,
+                                  ForecastMode mode) const {
+
+  if (mode == FORECAST_MEAN_ONLY) {
+    ForecastMean(x_, pending_dt_, horizon, steps, means);
+    return;
+  }
+
+  //one augmented sigma set for all output times
+  AugMatrix L;
+  AugSigmaMatrix Xsig_aug;
+  AugmentedSigmaPoints(&L, &Xsig_aug);
+
+  SigmaMatrix Xsig_pred;
+  for (int k = 0; k < steps; k++) {
+    SigmaPointPrediction(Xsig_aug, pending_dt_ + horizon * (k + 1) / steps, &Xsig_pred);
+
+    //predicted state mean
+    means[k].noalias() = Xsig_pred.template cast<T>() * weights_;
+    if (!covs)
+      continue;
+
+    //predicted state covariance matrix
+    covs[k].setZero();
+    for (int i = 0; i < n_sig_; i++) {  //iterate over sigma points
+      StateVector x_diff = Xsig_pred.col(i).template cast<T>() - means[k];
+      //angle normalization
+      while (x_diff(3)> M_PI) x_diff(3)-=2.*M_PI;
+      while (x_diff(3)<-M_PI) x_diff(3)+=2.*M_PI;
+      covs[k].noalias() += weights_(i) * x_diff * x_diff.transpose();
+    }
+  }
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::ForecastMean(const StateVector& x, double start, double horizon, int steps,
+                                      StateVector* means) {
+  //the state as one sigma point without noise, one lane per output time
+  const int kChunk = 16;
+  const int n_core = Motion::n_core;
+  TSig in[n_core + 2][kChunk], out[n_core][kChunk], dt[kChunk];
+  const TSig* rows_in[n_core + 2];
+  TSig* rows_out[n_core];
+  for (int r = 0; r < n_core + 2; r++)
+    rows_in[r] = in[r];
+  for (int r = 0; r < n_core; r++)
+    rows_out[r] = out[r];
+
+  for (int first = 0; first < steps; first += kChunk) {
+    const int n = std::min(kChunk, steps - first);
+    for (int i = 0; i < n; i++) {
+      dt[i] = start + horizon * (first + i + 1) / steps;
+      for (int r = 0; r < n_core; r++)
+        in[r][i] = x(r);
+      in[n_core][i] = 0;
+      in[n_core+1][i] = 0;
+    }
+    motion::PredictSigmaPoints<Motion>(rows_in, rows_out, dt, n);
+    for (int i = 0; i < n; i++) {
+      means[first + i] = x;
+      for (int r = 0; r < n_core; r++)
+        means[first + i](r) = out[r][i];
+    }
+  }
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::PredictMeanAndCovariance(void) {
+
+  //predicted state mean
+  x_.noalias() = Xsig_pred_.template cast<T>() * weights_;
+
+  //state differences
+  CenterSigmaPoints();
+  const DiffMatrix& Xdiff = ws_.Xdiff;
+
+  // square-root mode: factor straight from the sigma points
+  if (use_sqrt_ && ws_.sqrt_state.Compute(Xdiff, weights_, StateVector::Zero(), &S_)) {
+    P_.noalias() = S_ * S_.transpose();
+    return;
+  }
+
+  //predicted state covariance matrix
+  P_.setZero();
+  for (int i = 0; i < n_sig_; i++) {  //iterate over sigma points
+    P_.noalias() += weights_(i) * Xdiff.col(i) * Xdiff.col(i).transpose();
+  }
+
+  // square-root mode fallback when the downdate by the center point failed
+  if (use_sqrt_) {
+    ws_.state_llt.compute(P_);
+    S_ = ws_.state_llt.matrixL();
+  }
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::CenterSigmaPoints() {
+  DiffMatrix& Xdiff = ws_.Xdiff;
+  for (int i = 0; i < n_sig_; i++) {  //iterate over sigma points
+    Xdiff.col(i) = Xsig_pred_.col(i).template cast<T>() - x_;
+    //angle normalization
+    while (Xdiff(3,i)> M_PI) Xdiff(3,i)-=2.*M_PI;
+    while (Xdiff(3,i)<-M_PI) Xdiff(3,i)+=2.*M_PI;
+  }
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::RedrawSigmaPoints() {
+
+  //square root of P
+  StateMatrix& L = ws_.L_state;
+  if (use_sqrt_) {
+    L = S_;
+  } else {
+    ws_.state_llt.compute(P_);
+    L = ws_.state_llt.matrixL();
+  }
+
+  //same spread as AugmentedSigmaPoints, the noise dimensions stay at the
+  //mean since the noise does not act over a zero time step
+  Xsig_pred_.colwise() = x_.template cast<TSig>();
+  SigmaPoints::Spread(L, &Xsig_pred_);
+
+  CenterSigmaPoints();
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::UpdateLidar(const MeasurementPackage& meas_package) {
+  nis_laser_ = UpdateLinear(sensor::LidarModel(std_laspx_, std_laspy_),
+                            meas_package.raw_measurements_.template head<2>(), &ws_.lidar);
+  laser_updated_ = true;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::UpdateRadar(const MeasurementPackage& meas_package) {
+  nis_radar_ = UpdateUnscented(sensor::RadarModel(std_radr_, std_radphi_, std_radrd_),
+                               meas_package.raw_measurements_.template head<3>(), &ws_.radar);
+  radar_updated_ = true;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+template <class Model>
+double UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::UpdateLinear(const Model& model, const typename Model::Vector& z,
+                                      LinearWorkspace<Model::n_z>* w) {
+  const int n_z = Model::n_z;
+
+  //residual, H selects state components so z_pred is a subset of x_
+  for (int i = 0; i < n_z; i++)
+    w->z_diff(i) = z(i) - x_(model.state_index[i]);
+  model.NormalizeAngles(w->z_diff);
+
+  //P*H^T and the innovation covariance S = H*P*H^T + R
+  for (int j = 0; j < n_z; j++)
+    w->PHt.col(j) = P_.col(model.state_index[j]);
+  for (int i = 0; i < n_z; i++)
+    w->S.row(i) = w->PHt.row(model.state_index[i]);
+  model.AddNoise(w->S);
+
+  //Kalman gain K;
+  w->Si = sensor::Inverse(w->S);
+  w->K.noalias() = w->PHt * w->Si;
+  const double nis = sensor::Nis(w->Si, w->z_diff);
+  log_likelihood_ += sensor::LogLikelihood(w->S, nis);
+
+  //update state mean
+  x_.noalias() += w->K * w->z_diff;
+
+  if (use_sqrt_) {
+    //downdate S_ with K times the lower factor of S
+    Eigen::LLT<Eigen::Matrix<T, n_z, n_z, Eigen::DontAlign> > llt(w->S);
+    DowndateFactor<n_z>(w->K * llt.matrixL());
+    return nis;
+  }
+
+  //update state covariance matrix, K*S*K^T = K*H*P
+  P_.noalias() -= w->K * w->PHt.transpose();
+  return nis;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+template <class Model>
+double UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::UpdateUnscented(const Model& model, const typename Model::Vector& z,
+                                         UnscentedWorkspace<Model::n_z>* w) {
+
+  //transform sigma points into measurement space
+  model.Measure(Xsig_pred_, w->Zsig);
+
+  //mean predicted measurement
+  w->z_pred.noalias() = w->Zsig.template cast<T>() * weights_;
+
+  //centered sigma points, Xdiff is still valid from the prediction
+  w->Zdiff = w->Zsig.template cast<T>().colwise() - w->z_pred;
+  model.NormalizeAngles(w->Zdiff);
+
+  //innovation covariance matrix S and cross correlation matrix Tc
+  w->S.setZero();
+  w->Tc.setZero();
+  for (int i = 0; i < n_sig_; i++) {  //iterate over sigma points
+    w->S.noalias() += weights_(i) * w->Zdiff.col(i) * w->Zdiff.col(i).transpose();
+    w->Tc.noalias() += weights_(i) * ws_.Xdiff.col(i) * w->Zdiff.col(i).transpose();
+  }
+
+  //add measurement noise covariance matrix
+  model.AddNoise(w->S);
+
+  //residual
+  w->z_diff = z.template cast<T>() - w->z_pred;
+  model.NormalizeAngles(w->z_diff);
+
+  w->Si = sensor::Inverse(w->S);
+  const double nis = sensor::Nis(w->Si, w->z_diff);
+  log_likelihood_ += sensor::LogLikelihood(w->S, nis);
+
+  if (use_sqrt_) {
+    SqrtUpdate(model, w);
+    return nis;
+  }
+
+  //Kalman gain K;
+  w->K.noalias() = w->Tc * w->Si;
+
+  //update state mean and covariance matrix
+  x_.noalias() += w->K * w->z_diff;
+  P_.noalias() -= w->K * w->S * w->K.transpose();
+  return nis;
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+template <class Model>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::SqrtUpdate(const Model& model, UnscentedWorkspace<Model::n_z>* w) {
+  const int n_z = Model::n_z;
+  typedef Eigen::Matrix<T, n_z, n_z, Eigen::DontAlign> FactorZ;
+  typedef Eigen::Matrix<T, n_z, NX> GainT;
+
+  //lower factor of the innovation covariance
+  FactorZ Sz;
+  if (!w->sqrt.Compute(w->Zdiff, weights_, model.noise_std, &Sz)) {
+    Eigen::LLT<FactorZ> llt(w->S);
+    Sz = llt.matrixL();
+  }
+
+  //Kalman gain K = Tc * (Sz*Sz^T)^-1 through two triangular solves
+  GainT Kt = Sz.template triangularView<Eigen::Lower>().solve(w->Tc.transpose());
+  Sz.transpose().template triangularView<Eigen::Upper>().solveInPlace(Kt);
+
+  //update state mean
+  x_.noalias() += Kt.transpose() * w->z_diff;
+
+  //downdate S_ with every column of K*Sz
+  DowndateFactor<n_z>(Kt.transpose() * Sz);
+}
+
+template <int NX, int NAUG, typename T, typename TSig, template <int> class SigmaSet, class Motion>
+template <int NZ>
+void UKFFixed<NX, NAUG, T, TSig, SigmaSet, Motion>::DowndateFactor(const Eigen::Matrix<T, NX, NZ>& U) {
+  bool ok = true;
+  for (int j = 0; j < NZ && ok; j++) {
+    StateVector u = U.col(j);
+    ok = CholeskyRankUpdate(S_, u, -1.0);
+  }
+
+  if (ok) {
+    P_.noalias() = S_ * S_.transpose();
+  } else {
+    // lost positive definiteness on the way: fall back to the plain update
+    P_.noalias() -= U * U.transpose();
+    ws_.state_llt.compute(P_);
+    S_ = ws_.state_llt.matrixL();
+  }
+}
+
+#endif  // UKF_FIXED_H
@@ -0,0 +1,89 @@
+// Checks the lidar engines that skip boxes, the ObstacleGrid walk of
+// Analytic and the SectorTable packets of AnalyticPacket, against a scan
+// that tests every box for every ray. Run by ctest.
+
+#include "sensors/lidar.h"
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+// cloud of a scan testing every obstacle, with the noise Lidar::scan adds
+void BruteForceScan(const Lidar& lidar, pcl::PointCloud<pcl::PointXYZ>::VectorType* points) {
+  points->clear();
+  for (int i = 0; i < lidar.rays.size(); i++) {
+    Vect3 dir(lidar.rays.x[i], lidar.rays.y[i], lidar.rays.z[i]);
+    double t;
+    if (!rayIntersect(lidar.position, dir, lidar.obstacles, lidar.groundSlope, t) || t > lidar.maxDistance)
+      continue;
+    Vect3 hit(lidar.position.x + t * dir.x, lidar.position.y + t * dir.y, lidar.position.z + t * dir.z);
+    if (lidar.inRange(hit, t))
+      lidar.addPoint(i, hit, *points);
+  }
+}
+
+// largest coordinate difference of two clouds, infinity if their sizes differ
+double CloudDifference(const pcl::PointCloud<pcl::PointXYZ>::VectorType& a,
+                       const pcl::PointCloud<pcl::PointXYZ>::VectorType& b) {
+  if (a.size() != b.size())
+    return std::numeric_limits<double>::infinity();
+  double worst = 0;
+  for (size_t k = 0; k < a.size(); k++) {
+    worst = std::max(worst, (double)std::fabs(a[k].x - b[k].x));
+    worst = std::max(worst, (double)std::fabs(a[k].y - b[k].y));
+    worst = std::max(worst, (double)std::fabs(a[k].z - b[k].z));
+  }
+  return worst;
+}
+
+// cars spread over the road around the lidar, some turned, from a fixed
+// sequence so every run checks the same scenes
+std::vector<Car> Traffic(int n_cars, int scene) {
+  std::vector<Car> cars;
+  for (int k = 0; k < n_cars; k++) {
+    const double u = std::sin(12.9898 * (k + 1) + 78.233 * scene);
+    const double v = std::cos(4.1414 * (k + 1) + 3.7 * scene);
+    const double x = 60 * u;
+    const double y = k % 3 == 0 ? 4 * std::round(v) : 10 * v;
+    const double angle = k % 4 == 0 ? 0.0 : 0.6 * u * v;
+    // leave the ego car's footprint free
+    if (std::fabs(x) < 4 && std::fabs(y) < 2)
+      continue;
+    cars.push_back(Car(Vect3(x, y, 0), Vect3(4, 2, 2), Color(0, 0, 1), 0, angle, 2, "car"));
+  }
+  return cars;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  const int n_cars[] = {3, 30, 300};
+  const double pole_offsets[] = {0, 7.3, 41.9};
+  int scene = 0;
+  for (int n : n_cars) {
+    for (double distance : pole_offsets) {
+      const std::vector<Car> traffic = Traffic(n, scene);
+      Lidar lidar(traffic, 0);
+      // the poles are only in the cloud with the road widened
+      lidar.roadHalfWidth = 11;
+      lidar.updateScene(traffic, distance);
+
+      pcl::PointCloud<pcl::PointXYZ>::VectorType brute;
+      BruteForceScan(lidar, &brute);
+
+      lidar.castMethod = Analytic;
+      const double grid = CloudDifference(brute, lidar.scan()->points);
+      lidar.scanCount = 0;
+      lidar.castMethod = AnalyticPacket;
+      const double packet = CloudDifference(brute, lidar.scan()->points);
+
+      std::printf("%d cars, poles at %g: %zu points, grid diff %g, packet diff %g\n", n, distance, brute.size(), grid,
+                  packet);
+      ok = ok && grid == 0 && packet == 0;
+      scene++;
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+// Runs the filter predict/update path under the UKF_CHECK_NO_MALLOC hook,
+// which aborts if a guarded call allocates. Built with the define by ctest.
+
+#include "alloc_check.h"
+#include "ukf.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef UKF_CHECK_NO_MALLOC
+#error "no_alloc_check needs UKF_CHECK_NO_MALLOC"
+#endif
+
+namespace {
+
+// measurements built before the loop, so only the filter runs in it
+struct Frame {
+  MeasurementPackage meas_packages[2];
+};
+
+template <class Filter>
+void Run(const char* name, Filter* filter, const Frame* frames, int n_frames) {
+  for (int f = 0; f < n_frames; f++) {
+    if (f % 10 == 9) {
+      //the radar of every tenth frame arrives late, after the next lidar
+      filter->ProcessMeasurement(frames[f].meas_packages[0]);
+      filter->ProcessMeasurement(frames[f + 1].meas_packages[0]);
+      filter->ProcessMeasurement(frames[f].meas_packages[1]);
+      filter->ProcessMeasurement(frames[f + 1].meas_packages[1]);
+      f++;
+    } else {
+      filter->ProcessMeasurements(frames[f].meas_packages, 2);
+    }
+    filter->StateAt(frames[f].meas_packages[0].timestamp_ + 50000);
+  }
+  std::printf("%s: %d frames without allocating\n", name, n_frames);
+}
+
+}  // namespace
+
+int main() {
+  //the hook has to see allocations, or the runs below prove nothing
+  const long before = alloc_check::AllocationCount();
+  void* volatile probe = std::malloc(64);
+  const bool counting = alloc_check::AllocationCount() != before;
+  std::free(probe);
+  if (!counting) {
+    std::printf("allocations are not counted\n");
+    return 1;
+  }
+
+  const int n_frames = 200;
+  Frame* frames = new Frame[n_frames];
+  for (int f = 0; f < n_frames; f++) {
+    const double t = f * 0.1;
+    const double x = 10 + 5 * t;
+    const double y = 3 * std::sin(0.2 * t);
+    MeasurementPackage& lidar = frames[f].meas_packages[0];
+    lidar.sensor_type_ = MeasurementPackage::LASER;
+    lidar.timestamp_ = f * 100000LL;
+    lidar.raw_measurements_ = Eigen::VectorXd(2);
+    lidar.raw_measurements_ << x + 0.1 * std::sin(7.0 * f), y + 0.1 * std::cos(5.0 * f);
+    MeasurementPackage& radar = frames[f].meas_packages[1];
+    radar.sensor_type_ = MeasurementPackage::RADAR;
+    radar.timestamp_ = f * 100000LL;
+    radar.raw_measurements_ = Eigen::VectorXd(3);
+    radar.raw_measurements_ << std::sqrt(x * x + y * y), std::atan2(y, x), 5 + 0.2 * std::sin(3.0 * f);
+  }
+
+  UKF ukf;
+  ukf.SetHistoryDepth(8);
+  Run("UKF", &ukf, frames, n_frames);
+
+  UKF sqrt_ukf;
+  sqrt_ukf.use_sqrt_ = true;
+  sqrt_ukf.SetHistoryDepth(8);
+  Run("UKF square-root", &sqrt_ukf, frames, n_frames);
+
+  UKFFloat ukf_float;
+  Run("UKFFloat", &ukf_float, frames, n_frames);
+
+  UKFMixed ukf_mixed;
+  Run("UKFMixed", &ukf_mixed, frames, n_frames);
+
+  UKFSimplex ukf_simplex;
+  Run("UKFSimplex", &ukf_simplex, frames, n_frames);
+
+  delete[] frames;
+  return 0;
+}
@@ -0,0 +1,115 @@
+// Checks of UKFBank against UKF, run by ctest.
+
+#include "ukf_bank.h"
+#include "ukf.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+MeasurementPackage Lidar(long long timestamp, double px, double py) {
+  MeasurementPackage meas_package;
+  meas_package.sensor_type_ = MeasurementPackage::LASER;
+  meas_package.timestamp_ = timestamp;
+  meas_package.raw_measurements_ = Eigen::VectorXd(2);
+  meas_package.raw_measurements_ << px, py;
+  return meas_package;
+}
+
+MeasurementPackage Radar(long long timestamp, double rho, double phi, double rho_dot) {
+  MeasurementPackage meas_package;
+  meas_package.sensor_type_ = MeasurementPackage::RADAR;
+  meas_package.timestamp_ = timestamp;
+  meas_package.raw_measurements_ = Eigen::VectorXd(3);
+  meas_package.raw_measurements_ << rho, phi, rho_dot;
+  return meas_package;
+}
+
+// a frame of lidar then radar on every track follows UKF fed the same pairs
+// as one batch, the second update redrawing the sigma points
+bool LidarThenRadar() {
+  const int n = 8;
+  const int frames = 100;
+  UKFBank bank(n);
+  UKF ukf[n];
+  for (int k = 0; k < n; k++) {
+    MeasurementPackage first = Lidar(0, 5 + k, k - 4.0);
+    bank.AddTrack(first);
+    ukf[k].ProcessMeasurement(first);
+  }
+
+  double worst = 0;
+  for (int f = 1; f <= frames; f++) {
+    const long long timestamp = f * 100000LL;
+    double px[n], py[n], rho[n], phi[n], rho_dot[n];
+    for (int k = 0; k < n; k++) {
+      const double t = f * 0.1;
+      const double x = 5 + k + (3 + 0.2 * k) * t;
+      const double y = k - 4.0 + 2 * std::sin(0.1 * t + k);
+      px[k] = x + 0.1 * std::sin(7.0 * f + k);
+      py[k] = y + 0.1 * std::cos(5.0 * f + k);
+      rho[k] = std::sqrt(x * x + y * y) + 0.2 * std::sin(3.0 * f);
+      phi[k] = std::atan2(y, x) + 0.02 * std::cos(11.0 * f);
+      rho_dot[k] = 3 + 0.3 * std::sin(1.0 * f + k);
+      MeasurementPackage batch[2] = {Lidar(timestamp, px[k], py[k]), Radar(timestamp, rho[k], phi[k], rho_dot[k])};
+      ukf[k].ProcessMeasurements(batch, 2);
+    }
+    bank.Predict(0.1);
+    bank.UpdateLidar(px, py);
+    bank.UpdateRadar(rho, phi, rho_dot);
+    for (int k = 0; k < n; k++) {
+      const UKF::StateVector x = bank.State(k);
+      if (!x.allFinite())
+        worst = std::numeric_limits<double>::infinity();
+      else
+        worst = std::max(worst, (x - ukf[k].x_).cwiseAbs().maxCoeff());
+    }
+  }
+
+  std::printf("lidar then radar: max |bank - ukf| %g\n", worst);
+  return worst < 1e-9;
+}
+
+// a track left out by the active mask keeps its state and covariance bit
+// for bit, even with NaN in its measurement lanes
+bool InactiveLaneWithNaN() {
+  UKFBank bank(4);
+  for (int k = 0; k < 4; k++)
+    bank.AddTrack(Lidar(0, 10 + k, k));
+  bank.Predict(0.1);
+
+  const UKF::StateVector x_before = bank.State(2);
+  const UKF::StateMatrix P_before = bank.Covariance(2);
+
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double px[4] = {10.1, 11.1, nan, 13.1};
+  const double py[4] = {0.1, 1.1, nan, 3.1};
+  const double rho[4] = {10, 11, nan, 13};
+  const double phi[4] = {0, 0.1, nan, 0.2};
+  const double rho_dot[4] = {1, 1, nan, 1};
+  const unsigned char active[4] = {1, 1, 0, 1};
+  bank.UpdateLidar(px, py, active);
+  bank.UpdateRadar(rho, phi, rho_dot, active);
+
+  const UKF::StateVector x_after = bank.State(2);
+  const UKF::StateMatrix P_after = bank.Covariance(2);
+  const bool unchanged = std::memcmp(x_before.data(), x_after.data(), sizeof(double) * UKF::n_x_) == 0 &&
+                         std::memcmp(P_before.data(), P_after.data(), sizeof(double) * UKF::n_x_ * UKF::n_x_) == 0;
+  bool others_finite = true;
+  for (int k = 0; k < 4; k++)
+    others_finite = others_finite && (k == 2 || (bank.State(k).allFinite() && bank.Covariance(k).allFinite()));
+
+  std::printf("inactive lane with NaN: unchanged %d, active lanes finite %d\n", unchanged, others_finite);
+  return unchanged && others_finite;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = LidarThenRadar() && ok;
+  ok = InactiveLaneWithNaN() && ok;
+  return ok ? 0 : 1;
+}